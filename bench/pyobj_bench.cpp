@@ -0,0 +1,386 @@
+// Microbenchmarks for the pyobj wrappers. Every *_pyobj case has a
+// *_capi twin doing the same work with the raw C API, so the pair shows
+// what the wrapper costs. Export with
+//   pyobj_bench --benchmark_out=results.json --benchmark_out_format=json
+// and compare two runs with Google Benchmark's tools/compare.py.
+#include "pyobj.h"
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+using namespace py;
+
+namespace {
+
+// Builds a list of n ints counting down, so sorting has work to do
+PyObject* make_int_list(long n) {
+    PyObject* list = PyList_New(n);
+    for (long i = 0; i < n; ++i) PyList_SET_ITEM(list, i, PyLong_FromLong(n - i));
+    return list;
+}
+
+std::string make_csv(int fields) {
+    std::string text;
+    for (int i = 0; i < fields; ++i) {
+        if (i) text += ',';
+        text += "field" + std::to_string(i);
+    }
+    return text;
+}
+
+PyObject* json_function(const char* name) {
+    PyObject* module = PyImport_ImportModule("json");
+    PyObject* function = PyObject_GetAttrString(module, name);
+    Py_DECREF(module);
+    return function;
+}
+
+const char* const json_text =
+    R"({"id": 12345, "name": "widget", "tags": ["a", "b", "c"], "price": 9.75, )"
+    R"("stock": {"warehouse": 120, "shop": 8}, "active": true, "note": null})";
+
+// ================== Function::call ==================
+void BM_FunctionCall_pyobj(benchmark::State& state) {
+    Function function(eval_expr("lambda a, b: a"));
+    for (auto _ : state) benchmark::DoNotOptimize(function(1, 2));
+}
+BENCHMARK(BM_FunctionCall_pyobj);
+
+void BM_FunctionCall_capi(benchmark::State& state) {
+    PyObject* function = eval_expr("lambda a, b: a").release();
+    for (auto _ : state) {
+        PyObject* stack[3] = { nullptr, PyLong_FromLong(1), PyLong_FromLong(2) };
+        PyObject* result = PyObject_Vectorcall(function, stack + 1, 2 | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr);
+        Py_DECREF(stack[1]);
+        Py_DECREF(stack[2]);
+        benchmark::DoNotOptimize(result);
+        Py_XDECREF(result);
+    }
+    Py_DECREF(function);
+}
+BENCHMARK(BM_FunctionCall_capi);
+
+void BM_FunctionCallVector_pyobj(benchmark::State& state) {
+    Function function(eval_expr("lambda a, b: a"));
+    std::vector<PyObj> args = { PyObj(1), PyObj(2) };
+    for (auto _ : state) benchmark::DoNotOptimize(function.call(args));
+}
+BENCHMARK(BM_FunctionCallVector_pyobj);
+
+void BM_FunctionCallVector_capi(benchmark::State& state) {
+    PyObject* function = eval_expr("lambda a, b: a").release();
+    PyObject* args = PyTuple_Pack(2, PyObj(1).get_obj(), PyObj(2).get_obj());
+    for (auto _ : state) {
+        PyObject* result = PyObject_Call(function, args, nullptr);
+        benchmark::DoNotOptimize(result);
+        Py_XDECREF(result);
+    }
+    Py_DECREF(args);
+    Py_DECREF(function);
+}
+BENCHMARK(BM_FunctionCallVector_capi);
+
+// ================== Str::split / Str::join ==================
+void BM_StrSplit_pyobj(benchmark::State& state) {
+    Str text(make_csv(static_cast<int>(state.range(0))));
+    Str separator(",");
+    for (auto _ : state) benchmark::DoNotOptimize(text.split(separator));
+}
+BENCHMARK(BM_StrSplit_pyobj)->Arg(8)->Arg(256);
+
+void BM_StrSplit_capi(benchmark::State& state) {
+    std::string csv = make_csv(static_cast<int>(state.range(0)));
+    PyObject* text = PyUnicode_FromStringAndSize(csv.data(), csv.size());
+    PyObject* separator = PyUnicode_FromString(",");
+    for (auto _ : state) {
+        PyObject* parts = PyUnicode_Split(text, separator, -1);
+        benchmark::DoNotOptimize(parts);
+        Py_XDECREF(parts);
+    }
+    Py_DECREF(separator);
+    Py_DECREF(text);
+}
+BENCHMARK(BM_StrSplit_capi)->Arg(8)->Arg(256);
+
+void BM_StrJoin_pyobj(benchmark::State& state) {
+    std::vector<Str> parts = Str(make_csv(static_cast<int>(state.range(0)))).split(",");
+    Str separator(",");
+    for (auto _ : state) benchmark::DoNotOptimize(separator.join(parts));
+}
+BENCHMARK(BM_StrJoin_pyobj)->Arg(8)->Arg(256);
+
+void BM_StrJoin_capi(benchmark::State& state) {
+    std::string csv = make_csv(static_cast<int>(state.range(0)));
+    PyObject* text = PyUnicode_FromStringAndSize(csv.data(), csv.size());
+    PyObject* separator = PyUnicode_FromString(",");
+    PyObject* parts = PyUnicode_Split(text, separator, -1);
+    for (auto _ : state) {
+        PyObject* joined = PyUnicode_Join(separator, parts);
+        benchmark::DoNotOptimize(joined);
+        Py_XDECREF(joined);
+    }
+    Py_DECREF(parts);
+    Py_DECREF(separator);
+    Py_DECREF(text);
+}
+BENCHMARK(BM_StrJoin_capi)->Arg(8)->Arg(256);
+
+// ================== Dict through DictSetter ==================
+void BM_DictSetGet_pyobj(benchmark::State& state) {
+    Dict dict;
+    PyObj value(42);
+    for (auto _ : state) {
+        dict["counter"] = value;
+        PyObj read = dict["counter"];
+        benchmark::DoNotOptimize(read);
+    }
+}
+BENCHMARK(BM_DictSetGet_pyobj);
+
+void BM_DictSetGet_capi(benchmark::State& state) {
+    PyObject* dict = PyDict_New();
+    PyObject* key = PyUnicode_InternFromString("counter");
+    PyObject* value = PyLong_FromLong(42);
+    for (auto _ : state) {
+        PyDict_SetItem(dict, key, value);
+        PyObject* read = PyDict_GetItem(dict, key);
+        benchmark::DoNotOptimize(read);
+    }
+    Py_DECREF(value);
+    Py_DECREF(key);
+    Py_DECREF(dict);
+}
+BENCHMARK(BM_DictSetGet_capi);
+
+// ================== json_dumps / json_loads ==================
+void BM_JsonLoads_pyobj(benchmark::State& state) {
+    Str text(json_text);
+    for (auto _ : state) benchmark::DoNotOptimize(json_loads(text));
+}
+BENCHMARK(BM_JsonLoads_pyobj);
+
+void BM_JsonLoads_capi(benchmark::State& state) {
+    PyObject* loads = json_function("loads");
+    PyObject* text = PyUnicode_FromString(json_text);
+    for (auto _ : state) {
+        PyObject* value = PyObject_CallFunctionObjArgs(loads, text, nullptr);
+        benchmark::DoNotOptimize(value);
+        Py_XDECREF(value);
+    }
+    Py_DECREF(text);
+    Py_DECREF(loads);
+}
+BENCHMARK(BM_JsonLoads_capi);
+
+void BM_JsonDumps_pyobj(benchmark::State& state) {
+    PyObj value = json_loads(Str(json_text));
+    for (auto _ : state) benchmark::DoNotOptimize(json_dumps(value));
+}
+BENCHMARK(BM_JsonDumps_pyobj);
+
+void BM_JsonDumps_capi(benchmark::State& state) {
+    PyObject* dumps = json_function("dumps");
+    PyObj value = json_loads(Str(json_text));
+    for (auto _ : state) {
+        PyObject* text = PyObject_CallFunctionObjArgs(dumps, value.get_obj(), nullptr);
+        benchmark::DoNotOptimize(text);
+        Py_XDECREF(text);
+    }
+    Py_DECREF(dumps);
+}
+BENCHMARK(BM_JsonDumps_capi);
+
+// ================== eval ==================
+// eval() and eval_expr() reuse cached code, so the raw twins compile once
+// up front too and the pair compares running it
+void BM_EvalExpr_pyobj(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(eval_expr("3 * 7 + 1"));
+}
+BENCHMARK(BM_EvalExpr_pyobj);
+
+void BM_EvalExpr_capi(benchmark::State& state) {
+    PyObject* code = Py_CompileString("3 * 7 + 1", "<string>", Py_eval_input);
+    PyObject* globals = PyDict_New();
+    PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+    for (auto _ : state) {
+        PyObject* value = PyEval_EvalCode(code, globals, globals);
+        benchmark::DoNotOptimize(value);
+        Py_XDECREF(value);
+    }
+    Py_DECREF(globals);
+    Py_DECREF(code);
+}
+BENCHMARK(BM_EvalExpr_capi);
+
+void BM_Eval_pyobj(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(eval("x = 3 * 7 + 1"));
+}
+BENCHMARK(BM_Eval_pyobj);
+
+void BM_Eval_capi(benchmark::State& state) {
+    PyObject* code = Py_CompileString("x = 3 * 7 + 1", "<string>", Py_file_input);
+    for (auto _ : state) {
+        PyObject* globals = PyDict_New();
+        PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+        PyObject* result = PyEval_EvalCode(code, globals, globals);
+        Py_XDECREF(result);
+        benchmark::DoNotOptimize(globals);
+        Py_DECREF(globals);
+    }
+    Py_DECREF(code);
+}
+BENCHMARK(BM_Eval_capi);
+
+// ================== sorted ==================
+void BM_Sorted_pyobj(benchmark::State& state) {
+    List list(steal(make_int_list(state.range(0))));
+    for (auto _ : state) benchmark::DoNotOptimize(sorted(list));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Sorted_pyobj)->Arg(16)->Arg(4096);
+
+void BM_Sorted_capi(benchmark::State& state) {
+    PyObject* list = make_int_list(state.range(0));
+    for (auto _ : state) {
+        PyObject* copy = PySequence_List(list);
+        PyList_Sort(copy);
+        benchmark::DoNotOptimize(copy);
+        Py_DECREF(copy);
+    }
+    Py_DECREF(list);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Sorted_capi)->Arg(16)->Arg(4096);
+
+// ================== map ==================
+void BM_Map_pyobj(benchmark::State& state) {
+    Function function(eval_expr("lambda x: x + 1"));
+    List list(steal(make_int_list(state.range(0))));
+    for (auto _ : state) benchmark::DoNotOptimize(map(function, list));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Map_pyobj)->Arg(16)->Arg(4096);
+
+void BM_Map_capi(benchmark::State& state) {
+    PyObject* function = eval_expr("lambda x: x + 1").release();
+    PyObject* list = make_int_list(state.range(0));
+    for (auto _ : state) {
+        Py_ssize_t size = PyList_GET_SIZE(list);
+        PyObject* output = PyList_New(size);
+        for (Py_ssize_t i = 0; i < size; ++i) {
+            PyObject* stack[2] = { nullptr, PyList_GET_ITEM(list, i) };
+            PyList_SET_ITEM(output, i, PyObject_Vectorcall(function, stack + 1, 1 | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr));
+        }
+        benchmark::DoNotOptimize(output);
+        Py_DECREF(output);
+    }
+    Py_DECREF(list);
+    Py_DECREF(function);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Map_capi)->Arg(16)->Arg(4096);
+
+// The callable runs in C++ on native values instead of calling into Python
+void BM_MapNative_pyobj(benchmark::State& state) {
+    List list(steal(make_int_list(state.range(0))));
+    for (auto _ : state) benchmark::DoNotOptimize(map([](long x) { return x + 1; }, list, 1));
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MapNative_pyobj)->Arg(16)->Arg(4096);
+
+void BM_MapNative_capi(benchmark::State& state) {
+    PyObject* list = make_int_list(state.range(0));
+    for (auto _ : state) {
+        Py_ssize_t size = PyList_GET_SIZE(list);
+        std::vector<long> values(size);
+        for (Py_ssize_t i = 0; i < size; ++i) values[i] = PyLong_AsLong(PyList_GET_ITEM(list, i));
+        for (long& value : values) value += 1;
+
+        PyObject* output = PyList_New(size);
+        for (Py_ssize_t i = 0; i < size; ++i) PyList_SET_ITEM(output, i, PyLong_FromLong(values[i]));
+        benchmark::DoNotOptimize(output);
+        Py_DECREF(output);
+    }
+    Py_DECREF(list);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_MapNative_capi)->Arg(16)->Arg(4096);
+
+// ================== initializer_list construction ==================
+void BM_ListInit_pyobj(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(List{1, 2, 3, 4, 5, 6, 7, 8});
+}
+BENCHMARK(BM_ListInit_pyobj);
+
+void BM_ListInit_capi(benchmark::State& state) {
+    for (auto _ : state) {
+        PyObject* list = PyList_New(8);
+        for (long i = 0; i < 8; ++i) PyList_SET_ITEM(list, i, PyLong_FromLong(i + 1));
+        benchmark::DoNotOptimize(list);
+        Py_DECREF(list);
+    }
+}
+BENCHMARK(BM_ListInit_capi);
+
+void BM_TupleInit_pyobj(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(Tuple{1, 2.5, "three"});
+}
+BENCHMARK(BM_TupleInit_pyobj);
+
+void BM_TupleInit_capi(benchmark::State& state) {
+    for (auto _ : state) {
+        PyObject* tuple = Py_BuildValue("(ids)", 1, 2.5, "three");
+        benchmark::DoNotOptimize(tuple);
+        Py_DECREF(tuple);
+    }
+}
+BENCHMARK(BM_TupleInit_capi);
+
+void BM_SetInit_pyobj(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(Set{1, 2, 3, 4, 5, 6, 7, 8});
+}
+BENCHMARK(BM_SetInit_pyobj);
+
+void BM_SetInit_capi(benchmark::State& state) {
+    for (auto _ : state) {
+        PyObject* set = PySet_New(nullptr);
+        for (long i = 0; i < 8; ++i) {
+            PyObject* item = PyLong_FromLong(i + 1);
+            PySet_Add(set, item);
+            Py_DECREF(item);
+        }
+        benchmark::DoNotOptimize(set);
+        Py_DECREF(set);
+    }
+}
+BENCHMARK(BM_SetInit_capi);
+
+void BM_DictInit_pyobj(benchmark::State& state) {
+    for (auto _ : state) benchmark::DoNotOptimize(Dict{ {"x", 10}, {"y", "s"}, {"z", 30} });
+}
+BENCHMARK(BM_DictInit_pyobj);
+
+void BM_DictInit_capi(benchmark::State& state) {
+    for (auto _ : state) {
+        PyObject* dict = Py_BuildValue("{s:i,s:s,s:i}", "x", 10, "y", "s", "z", 30);
+        benchmark::DoNotOptimize(dict);
+        Py_DECREF(dict);
+    }
+}
+BENCHMARK(BM_DictInit_capi);
+
+} // end namespace
+
+// Python has to be up before the first case and stay up until the last
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    init_python();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    exit_python();
+    return 0;
+}
@@ -15,1819 +15,7662 @@
 
 
 #include <Python.h>
+#include <marshal.h>
 #include <string>
+#include <string_view>
 #include <vector>
+#include <tuple>
+#include <utility>
+#include <type_traits>
 #include <unordered_map>
+#include <map>
+#include <limits>
 #include <initializer_list>
 #include <iostream>
 #include <sstream>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <future>
+#include <functional>
+#include <condition_variable>
+#include <stdexcept>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <cerrno>
+#include <charconv>
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <chrono>
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#endif
+#include <new>
+#include <cmath>
+#if defined(PYOBJ_PARALLEL_SORT)
+#include <execution>
+#endif
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+
+#if PY_VERSION_HEX < 0x03090000
+#define PyObject_Vectorcall _PyObject_Vectorcall
+#define PyObject_VectorcallDict _PyObject_FastCallDict
+#endif
 
 
 namespace py {
 
 
 // ================== Python Initialization ==================
-inline void init_python() { 
-    if (!Py_IsInitialized()) Py_Initialize(); 
+namespace detail {
+// Thread state saved by init_python(true), restored again by exit_python()
+inline PyThreadState*& main_thread_state() {
+    static PyThreadState* state = nullptr;
+    return state;
 }
 
-inline void exit_python() { 
-    if (Py_IsInitialized()) Py_FinalizeEx(); 
+// Set on InterpreterPool workers, which hold their interpreter's GIL for
+// the whole time a job runs
+inline bool& owns_interpreter_gil() {
+    thread_local bool owned = false;
+    return owned;
 }
 
-// ================== Base PyObj Class ==================
-class PyObj {
-protected:
-    PyObject* obj;
+// Caches keep per-interpreter handles and register a hook here to drop them
+// when their interpreter goes away (exit_python() or an InterpreterPool
+// worker shutting down). Hooks run with that interpreter's GIL held.
+struct InterpreterExitHooks {
+    std::mutex mutex;
+    std::vector<std::function<void()>> hooks;
+};
 
-public:
-    // Constructors
-    PyObj(PyObject* o = nullptr) : obj(o) { Py_XINCREF(obj); }
-    PyObj(const PyObj& other) : obj(other.obj) { Py_XINCREF(obj); }
-    PyObj(PyObj&& other) noexcept : obj(other.obj) { other.obj = nullptr; }
-    
-    // Type conversion constructors
-    PyObj(int v) : obj(PyLong_FromLong(v)) {}
-    PyObj(long v) : obj(PyLong_FromLong(v)) {}
-    PyObj(double v) : obj(PyFloat_FromDouble(v)) {}
-    PyObj(bool v) : obj(v ? Py_True : Py_False) { Py_XINCREF(obj); }
-    PyObj(const std::string& s) : obj(PyUnicode_FromString(s.c_str())) {}
-    PyObj(const char* s) : obj(PyUnicode_FromString(s)) {}
+inline InterpreterExitHooks& interpreter_exit_hooks() {
+    static InterpreterExitHooks registry;
+    return registry;
+}
 
-    // Assignment operators
-    PyObj& operator=(const PyObj& other) {
-        if (this != &other) {
-            Py_XDECREF(obj);
-            obj = other.obj;
-            Py_XINCREF(obj);
-        }
-        return *this;
-    }
+inline void on_interpreter_exit(std::function<void()> hook) {
+    InterpreterExitHooks& registry = interpreter_exit_hooks();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.hooks.push_back(std::move(hook));
+}
 
-    PyObj& operator=(PyObj&& other) noexcept {
-        if (this != &other) {
-            Py_XDECREF(obj);
-            obj = other.obj;
-            other.obj = nullptr;
-        }
-        return *this;
-    }
+// Bumped whenever an interpreter goes away, per-thread caches that cannot
+// be reached from the exit hooks compare it to notice stale entries
+inline std::atomic<uint64_t>& interpreter_generation() {
+    static std::atomic<uint64_t> generation{1};
+    return generation;
+}
 
-    virtual ~PyObj() { Py_XDECREF(obj); }
+inline void run_interpreter_exit_hooks() {
+    interpreter_generation()++;
     
-    // Getters
-    PyObject* get_obj() const { return obj; }
-
-    // Type checking methods
-    bool is_empty() const {
-        if (!obj) return true;
-        if (PyUnicode_Check(obj)) return PyUnicode_GetLength(obj) == 0;
-        if (PyList_Check(obj)) return PyList_Size(obj) == 0;
-        if (PyDict_Check(obj)) return PyDict_Size(obj) == 0;
-        if (PySet_Check(obj)) return PySet_Size(obj) == 0;
-        return false;
+    InterpreterExitHooks& registry = interpreter_exit_hooks();
+    std::vector<std::function<void()>> hooks;
+    {
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        hooks = registry.hooks;
     }
+    for (auto& hook : hooks) hook();
+}
 
-    bool is_dict() const { return obj && PyDict_Check(obj); }
-    bool is_list() const { return obj && PyList_Check(obj); }
-    bool is_tuple() const { return obj && PyTuple_Check(obj); }
-    bool is_str() const { return obj && PyUnicode_Check(obj); }
-    bool is_set() const { return obj && PySet_Check(obj); }
-    bool is_sequence() const { return is_list() || is_tuple() || is_str(); }
-    bool is_callable() const { return obj && PyCallable_Check(obj); }
+inline int64_t interpreter_id() {
+    return PyInterpreterState_GetID(PyInterpreterState_Get());
+}
 
-    // Item access methods
-    PyObj get_item(const PyObj& key) const {
-        if (!obj) return PyObj();
-        
-        PyObject* result = PyDict_Check(obj) 
-            ? PyDict_GetItem(obj, key.get_obj())
-            : PyObject_GetItem(obj, key.get_obj());
-            
-        if (!result) { 
-            PyErr_Clear(); 
-            return PyObj(); 
-        }
-        
-        Py_XINCREF(result);
-        return PyObj(result);
+// ================== Interned Names ==================
+// Method names are interned once per thread and interpreter, keyed by the
+// address of the string literal. Borrowed reference.
+inline PyObject* interned(const char* name) {
+    struct NameCache {
+        int64_t interpreter = -1;
+        uint64_t generation = 0;
+        std::unordered_map<const char*, PyObject*> names;
+    };
+    thread_local NameCache cache;
+    
+    int64_t id = interpreter_id();
+    uint64_t generation = interpreter_generation().load(std::memory_order_relaxed);
+    if (cache.interpreter != id || cache.generation != generation) {
+        cache.names.clear();
+        cache.interpreter = id;
+        cache.generation = generation;
     }
+    
+    PyObject*& slot = cache.names[name];
+    if (!slot) slot = PyUnicode_InternFromString(name);
+    return slot;
+}
 
-    PyObj get_item(long index) const {
-        if (!obj) return PyObj();
+// Calls self.name(args...) through vectorcall without building a name
+// object or an argument tuple. Returns a new reference.
+template<typename... Objects>
+inline PyObject* call_method(PyObject* self, const char* name, Objects... args) {
+    PyObject* method_name = interned(name);
+    if (!self || !method_name) return nullptr;
+    
+    // Slot 0 stays free for PY_VECTORCALL_ARGUMENTS_OFFSET, self goes in slot 1
+    PyObject* stack[] = { nullptr, self, args... };
+    constexpr size_t count = 1 + sizeof...(Objects);
+    
+#if PY_VERSION_HEX >= 0x03090000
+    return PyObject_VectorcallMethod(method_name, stack + 1, count | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr);
+#else
+    PyObject* callable = PyObject_GetAttr(self, method_name);
+    if (!callable) return nullptr;
+    
+    PyObject* result = PyObject_Vectorcall(callable, stack + 2, count - 1, nullptr);
+    Py_DECREF(callable);
+    return result;
+#endif
+}
+} // end namespace detail
 
-        // Handle lists and tuples
-        if (PyList_Check(obj) || PyTuple_Check(obj)) {
-            Py_ssize_t size = PyList_Check(obj) 
-                ? PyList_Size(obj) 
-                : PyTuple_Size(obj);
-                
-            if (index < 0) index += size;
-            if (index < 0 || index >= size) return PyObj();
-            
-            PyObject* item = PyList_Check(obj) 
-                ? PyList_GetItem(obj, index) 
-                : PyTuple_GetItem(obj, index);
-                
-            Py_XINCREF(item);
-            return PyObj(item);
-        }
+// ================== Allocator Arena ==================
+namespace detail {
+// Optional PyMem hook (PythonConfig::arena) for the MEM and OBJ domains.
+// Small blocks requested inside an ArenaScope are bump-allocated from
+// per-thread chunks carved out of one reserved address range, so telling
+// arena blocks apart on free() is a range check; everything else goes to
+// the wrapped allocator. A chunk counts its live blocks, plus one while a
+// thread is filling it, and is recycled whole when that drops to zero:
+// objects that outlive their scope simply keep their chunk alive.
+struct ArenaChunk {
+    std::atomic<size_t> live;
+    ArenaChunk* next_free;
+};
 
-        // Handle strings
-        if (PyUnicode_Check(obj)) {
-            Py_ssize_t length = PyUnicode_GetLength(obj);
-            if (index < 0) index += length;
-            if (index < 0 || index >= length) return PyObj();
-            
-            Py_UCS4 character = PyUnicode_ReadChar(obj, index);
-            PyObject* temp = PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, &character, 1);
-            PyObj result(temp); 
-            Py_XDECREF(temp); 
-            return result;
-        }
+struct ArenaCounters {
+    uint64_t allocations = 0;  // blocks served from the arena
+    uint64_t bytes = 0;        // bytes requested for them
+    uint64_t fallbacks = 0;    // requests inside a scope left to the wrapped allocator
+};
 
-        // Generic case
-        PyObject* py_index = PyLong_FromLong(index);
-        PyObject* result = PyObject_GetItem(obj, py_index);
-        Py_XDECREF(py_index);
-        
-        if (!result) { 
-            PyErr_Clear(); 
-            return PyObj(); 
-        }
-        
-        Py_XINCREF(result);
-        return PyObj(result);
-    }
+struct Arena {
+    static constexpr size_t chunk_size = size_t(1) << 18;
+    static constexpr size_t chunk_header = 64;
+    static constexpr size_t block_header = 16;  // block size, keeps 16-byte alignment
+    static constexpr size_t max_block = 4096;
+    
+    char* base = nullptr;
+    size_t reserved = 0;
+    std::atomic<size_t> carved{0};
+    std::atomic<size_t> chunks_in_use{0};
+    
+    std::mutex mutex;
+    ArenaChunk* free_chunks = nullptr;
+    
+    PyMemAllocatorEx mem{};  // wrapped allocators, passed as ctx
+    PyMemAllocatorEx obj{};
+    bool installed = false;
+};
 
-    // Operator overloads for item access
-    PyObj operator[](const PyObj& key) const { return get_item(key); }
-    PyObj operator[](long index) const { return get_item(index); }
+// Never torn down: arena blocks may still be freed during finalization
+inline Arena& arena() {
+    static Arena* instance = new Arena();
+    return *instance;
+}
 
-    // Item setting methods
-    bool set_item(const PyObj& key, const PyObj& value) {
-        if (!obj) return false;
-        
-        return PyDict_Check(obj) 
-            ? PyDict_SetItem(obj, key.get_obj(), value.get_obj()) == 0
-            : PyObject_SetItem(obj, key.get_obj(), value.get_obj()) == 0;
-    }
+struct ArenaThread {
+    int depth = 0;
+    char* cursor = nullptr;
+    char* limit = nullptr;
+    ArenaChunk* chunk = nullptr;
+    ArenaCounters counters;
+};
 
-    bool set_item(long index, const PyObj& value) {
-        if (!obj) return false;
-        
-        if (PyList_Check(obj)) {
-            Py_ssize_t size = PyList_Size(obj); 
-            if (index < 0) index += size;
-            if (index < 0 || index >= size) return false;
-            
-            Py_XINCREF(value.get_obj());
-            return PyList_SetItem(obj, index, value.get_obj()) == 0;
-        }
-        
-        PyObject* py_index = PyLong_FromLong(index);
-        int success = PyObject_SetItem(obj, py_index, value.get_obj());
-        Py_XDECREF(py_index);
-        
-        return success == 0;
-    }
+inline ArenaThread& arena_thread() {
+    thread_local ArenaThread state;
+    return state;
+}
 
-    // ===== UNIVERSAL operator () for any type =====
-    template<typename... Args>
-    PyObj operator()(Args&&... args) const {
-        if (!obj || !PyCallable_Check(obj)) {
-            std::cerr << "Error: Object is not callable" << std::endl;
-            return PyObj();
-        }
+inline bool arena_owns(const void* p) {
+    const Arena& a = arena();
+    const char* address = static_cast<const char*>(p);
+    return address >= a.base && address < a.base + a.reserved;
+}
 
-        // Converting arguments to Python objects
-        std::vector<PyObject*> py_args;
-        (py_args.push_back(convert_to_pyobject(std::forward<Args>(args))), ...);
-        
-        // Create a tuple of arguments
-        PyObject* tuple = PyTuple_New(py_args.size());
-        for (size_t i = 0; i < py_args.size(); i++) {
-            PyTuple_SetItem(tuple, i, py_args[i]);
-        }
-        
-        // Calling a function
-        PyObject* result = PyObject_CallObject(obj, tuple);
-        Py_DECREF(tuple);
-        
-        if (!result) {
-            PyErr_Print();
-            return PyObj();
-        }
-        return PyObj(result);
-    }
+inline void release_chunk(ArenaChunk* chunk) {
+    if (chunk->live.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+    
+    Arena& a = arena();
+    std::lock_guard<std::mutex> lock(a.mutex);
+    chunk->next_free = a.free_chunks;
+    a.free_chunks = chunk;
+    a.chunks_in_use.fetch_sub(1, std::memory_order_relaxed);
+}
 
-    // String representation
-    std::string str() const {
-        if (!obj) return "None";
-        
-        PyObject* string_obj = PyObject_Str(obj);
-        if (!string_obj) { 
-            PyErr_Clear(); 
-            return "<error>"; 
+inline ArenaChunk* acquire_chunk() {
+    Arena& a = arena();
+    ArenaChunk* chunk = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(a.mutex);
+        if (a.free_chunks) {
+            chunk = a.free_chunks;
+            a.free_chunks = chunk->next_free;
         }
+    }
+    
+    if (!chunk) {
+        size_t offset = a.carved.fetch_add(Arena::chunk_size, std::memory_order_relaxed);
+        if (offset + Arena::chunk_size > a.reserved) return nullptr;
         
-        const char* c_str = PyUnicode_AsUTF8(string_obj);
-        std::string result = c_str ? c_str : "";
-        Py_XDECREF(string_obj);
-        
-        return result;
+        char* memory = a.base + offset;
+#ifdef _WIN32
+        if (!VirtualAlloc(memory, Arena::chunk_size, MEM_COMMIT, PAGE_READWRITE)) return nullptr;
+#endif
+        chunk = new (memory) ArenaChunk();
     }
+    
+    chunk->live.store(1, std::memory_order_relaxed);
+    a.chunks_in_use.fetch_add(1, std::memory_order_relaxed);
+    return chunk;
+}
 
-    // Pretty printing
-    static void pretty_print(std::ostream& os, const PyObj& obj, int indent = 0);
+inline void retire_thread_chunk(ArenaThread& state) {
+    if (!state.chunk) return;
+    release_chunk(state.chunk);
+    state.chunk = nullptr;
+    state.cursor = state.limit = nullptr;
+}
 
-private:
-    // Helper methods for argument conversion
-    PyObject* convert_to_pyobject(const PyObj& arg) const {
-        Py_XINCREF(arg.get_obj());
-        return arg.get_obj();
-    }
+inline void* arena_malloc(void* ctx, size_t size) {
+    const PyMemAllocatorEx* wrapped = static_cast<const PyMemAllocatorEx*>(ctx);
+    ArenaThread& state = arena_thread();
+    if (state.depth == 0) return wrapped->malloc(wrapped->ctx, size);
     
-    PyObject* convert_to_pyobject(int arg) const {
-        return PyLong_FromLong(arg);
+    size_t need = Arena::block_header + ((std::max<size_t>(size, 1) + 15) & ~size_t(15));
+    if (size > Arena::max_block) {
+        state.counters.fallbacks++;
+        return wrapped->malloc(wrapped->ctx, size);
     }
     
-    PyObject* convert_to_pyobject(long arg) const {
-        return PyLong_FromLong(arg);
+    if (static_cast<size_t>(state.limit - state.cursor) < need) {
+        retire_thread_chunk(state);
+        state.chunk = acquire_chunk();
+        if (!state.chunk) {
+            state.counters.fallbacks++;
+            return wrapped->malloc(wrapped->ctx, size);
+        }
+        state.cursor = reinterpret_cast<char*>(state.chunk) + Arena::chunk_header;
+        state.limit = reinterpret_cast<char*>(state.chunk) + Arena::chunk_size;
     }
     
-    PyObject* convert_to_pyobject(double arg) const {
-        return PyFloat_FromDouble(arg);
-    }
+    char* block = state.cursor;
+    state.cursor += need;
+    *reinterpret_cast<size_t*>(block) = size;
+    state.chunk->live.fetch_add(1, std::memory_order_relaxed);
     
-    PyObject* convert_to_pyobject(bool arg) const {
-        return PyBool_FromLong(arg);
-    }
+    state.counters.allocations++;
+    state.counters.bytes += size;
+    return block + Arena::block_header;
+}
+
+inline void* arena_calloc(void* ctx, size_t count, size_t size) {
+    const PyMemAllocatorEx* wrapped = static_cast<const PyMemAllocatorEx*>(ctx);
+    if (arena_thread().depth == 0 || (size && count > Arena::max_block / size)) 
+        return wrapped->calloc(wrapped->ctx, count, size);
     
-    PyObject* convert_to_pyobject(const std::string& arg) const {
-        return PyUnicode_FromString(arg.c_str());
-    }
+    void* p = arena_malloc(ctx, count * size);
+    if (p) std::memset(p, 0, count * size);
+    return p;
+}
+
+inline void arena_free(void* ctx, void* p) {
+    if (!p) return;
     
-    PyObject* convert_to_pyobject(const char* arg) const {
-        return PyUnicode_FromString(arg);
+    if (arena_owns(p)) {
+        const Arena& a = arena();
+        size_t offset = (static_cast<char*>(p) - a.base) & ~(Arena::chunk_size - 1);
+        release_chunk(reinterpret_cast<ArenaChunk*>(a.base + offset));
+        return;
     }
-};
-
-// ================== String Class ==================
-class Str : public PyObj {
-public:
-    // Constructors
-    Str() : PyObj("") {}
-    Str(const std::string& s) : PyObj(s) {}
-    Str(const char* s) : PyObj(s) {}
-    Str(PyObject* o) : PyObj(o) {}
-    Str(const PyObj& o) : PyObj(o.get_obj()) {}
+    
+    const PyMemAllocatorEx* wrapped = static_cast<const PyMemAllocatorEx*>(ctx);
+    wrapped->free(wrapped->ctx, p);
+}
 
-    // String manipulation methods
-    Str capitalize() const { 
-        PyObject* result = PyObject_CallMethod(obj, "capitalize", nullptr); 
-        return Str(result); 
-    }
+inline void* arena_realloc(void* ctx, void* p, size_t size) {
+    if (!p) return arena_malloc(ctx, size);
     
-    Str upper() const { 
-        PyObject* result = PyObject_CallMethod(obj, "upper", nullptr); 
-        return Str(result); 
+    if (!arena_owns(p)) {
+        const PyMemAllocatorEx* wrapped = static_cast<const PyMemAllocatorEx*>(ctx);
+        return wrapped->realloc(wrapped->ctx, p, size);
     }
     
-    Str lower() const { 
-        PyObject* result = PyObject_CallMethod(obj, "lower", nullptr); 
-        return Str(result); 
-    }
+    size_t old_size = *reinterpret_cast<size_t*>(static_cast<char*>(p) - Arena::block_header);
+    if (size <= old_size) return p;
     
-    Str title() const { 
-        PyObject* result = PyObject_CallMethod(obj, "title", nullptr); 
-        return Str(result); 
-    }
+    void* moved = arena_malloc(ctx, size);
+    if (!moved) return nullptr;
     
-    Str swapcase() const { 
-        PyObject* result = PyObject_CallMethod(obj, "swapcase", nullptr); 
-        return Str(result); 
-    }
+    std::memcpy(moved, p, old_size);
+    arena_free(ctx, p);
+    return moved;
+}
+
+// Hooks the allocators; also safe after Py_Initialize() because blocks
+// from before are handed back to the allocator that made them
+inline bool install_arena(size_t reserve) {
+    Arena& a = arena();
+    if (a.installed) return true;
     
-    Str strip() const { 
-        PyObject* result = PyObject_CallMethod(obj, "strip", nullptr); 
-        return Str(result); 
-    }
+    reserve = (reserve + Arena::chunk_size - 1) & ~(Arena::chunk_size - 1);
     
-    Str lstrip() const { 
-        PyObject* result = PyObject_CallMethod(obj, "lstrip", nullptr); 
-        return Str(result); 
-    }
+    // One extra chunk of address space so the range can start chunk-aligned
+#ifdef _WIN32
+    void* region = VirtualAlloc(nullptr, reserve + Arena::chunk_size, MEM_RESERVE, PAGE_NOACCESS);
+    if (!region) return false;
+#else
+    void* region = mmap(nullptr, reserve + Arena::chunk_size, PROT_READ | PROT_WRITE, 
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (region == MAP_FAILED) return false;
+#endif
     
-    Str rstrip() const { 
-        PyObject* result = PyObject_CallMethod(obj, "rstrip", nullptr); 
-        return Str(result); 
-    }
+    uintptr_t aligned = (reinterpret_cast<uintptr_t>(region) + Arena::chunk_size - 1) & ~uintptr_t(Arena::chunk_size - 1);
+    a.base = reinterpret_cast<char*>(aligned);
+    a.reserved = reserve;
+    
+    PyMem_GetAllocator(PYMEM_DOMAIN_MEM, &a.mem);
+    PyMem_GetAllocator(PYMEM_DOMAIN_OBJ, &a.obj);
+    
+    PyMemAllocatorEx mem_hook = { &a.mem, arena_malloc, arena_calloc, arena_realloc, arena_free };
+    PyMemAllocatorEx obj_hook = { &a.obj, arena_malloc, arena_calloc, arena_realloc, arena_free };
+    PyMem_SetAllocator(PYMEM_DOMAIN_MEM, &mem_hook);
+    PyMem_SetAllocator(PYMEM_DOMAIN_OBJ, &obj_hook);
+    
+    a.installed = true;
+    return true;
+}
+} // end namespace detail
 
-    // String validation methods
-    bool isdigit() const { 
-        PyObject* result = PyObject_CallMethod(obj, "isdigit", nullptr); 
-        bool value = result && PyObject_IsTrue(result); 
-        Py_XDECREF(result); 
-        return value; 
+// Routes Python allocations made on this thread to the arena while alive
+// and counts them. Scopes nest; the outermost one hands its chunk back on
+// exit. Without PythonConfig::arena it only counts nothing.
+class ArenaScope {
+    detail::ArenaCounters start;
+
+public:
+    ArenaScope() : start(detail::arena_thread().counters) { 
+        detail::arena_thread().depth++; 
     }
     
-    bool isalpha() const { 
-        PyObject* result = PyObject_CallMethod(obj, "isalpha", nullptr); 
-        bool value = result && PyObject_IsTrue(result); 
-        Py_XDECREF(result); 
-        return value; 
-    }
-    
-    bool isalnum() const { 
-        PyObject* result = PyObject_CallMethod(obj, "isalnum", nullptr); 
-        bool value = result && PyObject_IsTrue(result); 
-        Py_XDECREF(result); 
-        return value; 
+    ~ArenaScope() {
+        detail::ArenaThread& state = detail::arena_thread();
+        if (--state.depth == 0) detail::retire_thread_chunk(state);
     }
     
-    bool isdecimal() const { 
-        PyObject* result = PyObject_CallMethod(obj, "isdecimal", nullptr); 
-        bool value = result && PyObject_IsTrue(result); 
-        Py_XDECREF(result); 
-        return value; 
-    }
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
     
-    bool isnumeric() const { 
-        PyObject* result = PyObject_CallMethod(obj, "isnumeric", nullptr); 
-        bool value = result && PyObject_IsTrue(result); 
-        Py_XDECREF(result); 
-        return value; 
-    }
+    uint64_t allocations() const { return detail::arena_thread().counters.allocations - start.allocations; }
+    uint64_t bytes() const { return detail::arena_thread().counters.bytes - start.bytes; }
+    uint64_t fallbacks() const { return detail::arena_thread().counters.fallbacks - start.fallbacks; }
+};
+
+struct ArenaStats {
+    bool enabled;
+    size_t reserved_bytes;
+    size_t chunk_bytes;
+    size_t chunks_in_use;
+    size_t chunks_carved;
+};
+
+inline ArenaStats arena_stats() {
+    const detail::Arena& a = detail::arena();
+    size_t carved = std::min(a.carved.load(std::memory_order_relaxed), a.reserved);
+    return { a.installed, a.reserved, detail::Arena::chunk_size, 
+             a.chunks_in_use.load(std::memory_order_relaxed), carved / detail::Arena::chunk_size };
+}
+
+// ================== Startup Options ==================
+struct PythonConfig {
+    // Drop the GIL after startup, see init_python(bool)
+    bool release_gil = false;
     
-    bool istitle() const { 
-        PyObject* result = PyObject_CallMethod(obj, "istitle", nullptr); 
-        bool value = result && PyObject_IsTrue(result); 
-        Py_XDECREF(result); 
-        return value; 
-    }
+    // Install the allocator arena used by ArenaScope
+    bool arena = false;
+    size_t arena_reserve = size_t(1) << 30;  // address space for arena chunks
+};
+
+// With release_gil the GIL is dropped after startup, every thread (the main
+// one included) then takes it with gil_acquire before touching Python objects.
+inline void init_python(const PythonConfig& config) { 
+    if (Py_IsInitialized()) return;
     
-    bool isupper() const { 
-        PyObject* result = PyObject_CallMethod(obj, "isupper", nullptr); 
-        bool value = result && PyObject_IsTrue(result); 
-        Py_XDECREF(result); 
-        return value; 
-    }
+    if (config.arena) detail::install_arena(config.arena_reserve);
     
-    bool islower() const { 
-        PyObject* result = PyObject_CallMethod(obj, "islower", nullptr); 
-        bool value = result && PyObject_IsTrue(result); 
-        Py_XDECREF(result); 
-        return value; 
-    }
+    Py_Initialize(); 
+    if (config.release_gil) detail::main_thread_state() = PyEval_SaveThread();
+}
 
-    // Search methods
-    long find(const Str& substring) const { 
-        PyObject* result = PyObject_CallMethod(obj, "find", "O", substring.get_obj()); 
-        long value = result ? PyLong_AsLong(result) : -1; 
-        Py_XDECREF(result); 
-        return value; 
-    }
+inline void init_python(bool release_gil = false) { 
+    PythonConfig config;
+    config.release_gil = release_gil;
+    init_python(config);
+}
+
+inline void exit_python() { 
+    if (!Py_IsInitialized()) return;
     
-    long rfind(const Str& substring) const { 
-        PyObject* result = PyObject_CallMethod(obj, "rfind", "O", substring.get_obj()); 
-        long value = result ? PyLong_AsLong(result) : -1; 
-        Py_XDECREF(result); 
-        return value; 
+    PyThreadState*& state = detail::main_thread_state();
+    if (state) {
+        PyEval_RestoreThread(state);
+        state = nullptr;
     }
     
-    long index(const Str& substring) const { 
-        PyObject* result = PyObject_CallMethod(obj, "index", "O", substring.get_obj()); 
-        long value = result ? PyLong_AsLong(result) : -1; 
-        Py_XDECREF(result); 
-        return value; 
-    }
+    detail::run_interpreter_exit_hooks();
+    Py_FinalizeEx(); 
+}
+
+// ================== Profiling ==================
+// Build with -DPYOBJ_PROFILE to count calls, latency and handles created for
+// each wrapper entry point, the time spent waiting for the GIL and the
+// reference traffic of all handles. Without it every probe is an empty
+// object and compiles to nothing; stats() then reports enabled = false.
+#ifdef PYOBJ_PROFILE
+inline constexpr bool profiling = true;
+#else
+inline constexpr bool profiling = false;
+#endif
+
+// Instrumented entry points. Latency is inclusive: eval_expr() called from
+// a Python callback inside Function::call counts towards both.
+enum class Api : unsigned char {
+    Eval, EvalExpr, Exec, RunCode, RunFile,
+    FunctionCall, FunctionBatch,
+    JsonDumps, JsonLoads, JsonDump, JsonLoad,
+    StrMethod, StrSplit, StrJoin,
+    ToVector, FromVector, ToMap, FromMap,
+    GilWait,
+    Count
+};
+
+inline const char* api_name(Api api) {
+    static const char* const names[] = {
+        "eval", "eval_expr", "exec", "run_code", "run_file",
+        "function_call", "function_batch",
+        "json_dumps", "json_loads", "json_dump", "json_load",
+        "str_method", "str_split", "str_join",
+        "to_vector", "from_vector", "to_map", "from_map",
+        "gil_wait"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == size_t(Api::Count), "api_name: one name per Api");
+    return api < Api::Count ? names[size_t(api)] : "unknown";
+}
+
+// Upper bounds of the latency histogram buckets, a last bucket takes the rest
+inline constexpr std::array<uint64_t, 19> latency_bounds_ns = {
+    1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+    1000000, 2500000, 5000000, 10000000, 25000000, 50000000, 100000000, 250000000, 500000000,
+    1000000000
+};
+
+struct ApiStats {
+    Api api;
+    const char* name;
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t objects;  // handles that took over a new reference during the calls
+    std::array<uint64_t, latency_bounds_ns.size() + 1> histogram;  // calls per bucket
+};
+
+struct Stats {
+    bool enabled;
+    std::vector<ApiStats> apis;  // entry points called at least once
+    uint64_t handles_adopted;    // new references handed to a handle
+    uint64_t references_taken;   // Py_INCREF by a handle
+    uint64_t references_released;
+};
+
+namespace detail {
+struct ApiCounters {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> total_ns{0};
+    std::atomic<uint64_t> max_ns{0};
+    std::atomic<uint64_t> objects{0};
+    std::array<std::atomic<uint64_t>, latency_bounds_ns.size() + 1> histogram{};
+};
+
+struct ProfileTable {
+    std::array<ApiCounters, size_t(Api::Count)> apis;
+    std::atomic<uint64_t> adopted{0};
+    std::atomic<uint64_t> taken{0};
+    std::atomic<uint64_t> released{0};
+};
+
+inline ProfileTable& profile_table() {
+    static ProfileTable table;
+    return table;
+}
+
+// Handles adopted on this thread, so each probe can tell what its call created
+inline uint64_t& thread_adopted() {
+    thread_local uint64_t adopted = 0;
+    return adopted;
+}
+
+inline uint64_t profile_clock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void record_call(Api api, uint64_t elapsed, uint64_t objects) {
+    ApiCounters& counters = profile_table().apis[size_t(api)];
+    counters.calls.fetch_add(1, std::memory_order_relaxed);
+    counters.total_ns.fetch_add(elapsed, std::memory_order_relaxed);
+    counters.objects.fetch_add(objects, std::memory_order_relaxed);
     
-    long rindex(const Str& substring) const { 
-        PyObject* result = PyObject_CallMethod(obj, "rindex", "O", substring.get_obj()); 
-        long value = result ? PyLong_AsLong(result) : -1; 
-        Py_XDECREF(result); 
-        return value; 
-    }
+    size_t bucket = std::lower_bound(latency_bounds_ns.begin(), latency_bounds_ns.end(), elapsed) - latency_bounds_ns.begin();
+    counters.histogram[bucket].fetch_add(1, std::memory_order_relaxed);
     
-    Str replace(const Str& old_str, const Str& new_str) const { 
-        PyObject* result = PyObject_CallMethod(obj, "replace", "OO", old_str.get_obj(), new_str.get_obj()); 
-        return Str(result); 
-    }
+    uint64_t seen = counters.max_ns.load(std::memory_order_relaxed);
+    while (elapsed > seen && !counters.max_ns.compare_exchange_weak(seen, elapsed, std::memory_order_relaxed)) {}
+}
 
-    // Split and join methods
-    std::vector<Str> split(const Str& separator = "") const {
-        PyObject* result = separator.str().empty() 
-            ? PyObject_CallMethod(obj, "split", nullptr) 
-            : PyObject_CallMethod(obj, "split", "O", separator.get_obj());
-            
-        std::vector<Str> output;
-        if (!result) { 
-            PyErr_Clear(); 
-            return output; 
-        }
-        
-        if (PyList_Check(result)) {
-            Py_ssize_t size = PyList_Size(result);
-            for (Py_ssize_t i = 0; i < size; ++i) {
-                PyObject* item = PyList_GetItem(result, i); 
-                Py_XINCREF(item); 
-                output.emplace_back(item); 
-            }
-        }
-        
-        Py_XDECREF(result);
-        return output;
-    }
+// Times the enclosing scope against one entry point
+template<Api A, bool Enabled = profiling>
+class ApiProbe {
+public:
+    ApiProbe() {}
+};
 
-    Str join(const std::vector<Str>& sequence) const {
-        PyObject* list_obj = PyList_New(sequence.size());
-        if (!list_obj) return Str();
-        
-        for (Py_ssize_t i = 0; i < sequence.size(); ++i) {
-            Py_XINCREF(sequence[i].get_obj()); 
-            PyList_SetItem(list_obj, i, sequence[i].get_obj()); 
-        }
-        
-        PyObject* result = PyObject_CallMethod(obj, "join", "O", list_obj);
-        Py_XDECREF(list_obj);
-        
-        return Str(result);
-    }
+template<Api A>
+class ApiProbe<A, true> {
+    uint64_t start;
+    uint64_t adopted;
 
-    // Length and indexing
-    long len() const { return obj ? PyUnicode_GetLength(obj) : 0; }
+public:
+    ApiProbe() : start(profile_clock()), adopted(thread_adopted()) {}
+    ~ApiProbe() { record_call(A, profile_clock() - start, thread_adopted() - adopted); }
 
-    Str operator[](long index) const {
-        Py_ssize_t length = len(); 
-        if (index < 0) index += length; 
-        if (index < 0 || index >= length) return Str();
-        
-        Py_UCS4 character = PyUnicode_ReadChar(obj, index);
-        PyObject* temp = PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, &character, 1);
-        Str result(temp); 
-        Py_XDECREF(temp); 
-        return result;
-    }
+    ApiProbe(const ApiProbe&) = delete;
+    ApiProbe& operator=(const ApiProbe&) = delete;
+};
 
-    // String concatenation and repetition
-    Str operator+(const Str& other) const {
-        PyObject* result = PyUnicode_Concat(obj, other.get_obj());
-        return Str(result);
+// Reference traffic of the handles
+inline void note_adopted(PyObject* o) {
+    if constexpr (profiling) {
+        if (!o) return;
+        ++thread_adopted();
+        profile_table().adopted.fetch_add(1, std::memory_order_relaxed);
     }
+}
 
-    Str& operator+=(const Str& other) {
-        PyObject* result = PyUnicode_Concat(obj, other.get_obj());
-        if (result) { 
-            Py_XDECREF(obj); 
-            obj = result; 
-        }
-        return *this;
+inline void note_taken(PyObject* o) {
+    if constexpr (profiling) {
+        if (o) profile_table().taken.fetch_add(1, std::memory_order_relaxed);
     }
+}
 
-    Str operator*(long n) const {
-        PyObject* result = PySequence_Repeat(obj, n);
-        return Str(result);
+inline void note_released(PyObject* o) {
+    if constexpr (profiling) {
+        if (o) profile_table().released.fetch_add(1, std::memory_order_relaxed);
     }
+}
+} // end namespace detail
 
-    Str& operator*=(long n) {
-        PyObject* result = PySequence_Repeat(obj, n);
-        if (result) { 
-            Py_XDECREF(obj); 
-            obj = result; 
+inline Stats stats() {
+    Stats snapshot{profiling, {}, 0, 0, 0};
+    if constexpr (profiling) {
+        const detail::ProfileTable& table = detail::profile_table();
+        for (size_t i = 0; i < size_t(Api::Count); ++i) {
+            const detail::ApiCounters& counters = table.apis[i];
+            
+            ApiStats entry{Api(i), api_name(Api(i)), counters.calls.load(std::memory_order_relaxed),
+                           counters.total_ns.load(std::memory_order_relaxed),
+                           counters.max_ns.load(std::memory_order_relaxed),
+                           counters.objects.load(std::memory_order_relaxed), {}};
+            if (entry.calls == 0) continue;
+            
+            for (size_t b = 0; b < entry.histogram.size(); ++b) 
+                entry.histogram[b] = counters.histogram[b].load(std::memory_order_relaxed);
+            snapshot.apis.push_back(entry);
         }
-        return *this;
+        snapshot.handles_adopted = table.adopted.load(std::memory_order_relaxed);
+        snapshot.references_taken = table.taken.load(std::memory_order_relaxed);
+        snapshot.references_released = table.released.load(std::memory_order_relaxed);
     }
+    return snapshot;
+}
 
-    // Comparison operators
-    bool operator==(const Str& other) const { 
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_EQ) == 1; 
+inline void reset_stats() {
+    if constexpr (profiling) {
+        detail::ProfileTable& table = detail::profile_table();
+        for (detail::ApiCounters& counters : table.apis) {
+            counters.calls = 0;
+            counters.total_ns = 0;
+            counters.max_ns = 0;
+            counters.objects = 0;
+            for (auto& bucket : counters.histogram) bucket = 0;
+        }
+        table.adopted = 0;
+        table.taken = 0;
+        table.released = 0;
     }
+}
+
+// Prometheus text exposition format, ready to serve from a /metrics endpoint
+inline std::string stats_prometheus() {
+    Stats snapshot = stats();
+    std::ostringstream out;
+    out.precision(9);
     
-    bool operator!=(const Str& other) const { 
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_NE) == 1; 
-    }
+    out << "# HELP pyobj_profile_enabled Whether pyobj was built with PYOBJ_PROFILE\n"
+        << "# TYPE pyobj_profile_enabled gauge\n"
+        << "pyobj_profile_enabled " << (snapshot.enabled ? 1 : 0) << "\n";
     
-    bool operator<(const Str& other) const { 
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LT) == 1; 
+    out << "# HELP pyobj_call_seconds Latency of pyobj entry points\n"
+        << "# TYPE pyobj_call_seconds histogram\n";
+    for (const ApiStats& entry : snapshot.apis) {
+        uint64_t cumulative = 0;
+        for (size_t b = 0; b < entry.histogram.size(); ++b) {
+            cumulative += entry.histogram[b];
+            out << "pyobj_call_seconds_bucket{api=\"" << entry.name << "\",le=\"";
+            if (b < latency_bounds_ns.size()) out << latency_bounds_ns[b] / 1e9;
+            else out << "+Inf";
+            out << "\"} " << cumulative << "\n";
+        }
+        out << "pyobj_call_seconds_sum{api=\"" << entry.name << "\"} " << entry.total_ns / 1e9 << "\n"
+            << "pyobj_call_seconds_count{api=\"" << entry.name << "\"} " << entry.calls << "\n";
     }
     
-    bool operator>(const Str& other) const { 
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GT) == 1; 
-    }
+    out << "# HELP pyobj_call_max_seconds Slowest call of each entry point\n"
+        << "# TYPE pyobj_call_max_seconds gauge\n";
+    for (const ApiStats& entry : snapshot.apis)
+        out << "pyobj_call_max_seconds{api=\"" << entry.name << "\"} " << entry.max_ns / 1e9 << "\n";
     
-    bool operator<=(const Str& other) const { 
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LE) == 1; 
-    }
+    out << "# HELP pyobj_objects_created_total Handles adopting a new reference inside each entry point\n"
+        << "# TYPE pyobj_objects_created_total counter\n";
+    for (const ApiStats& entry : snapshot.apis)
+        out << "pyobj_objects_created_total{api=\"" << entry.name << "\"} " << entry.objects << "\n";
     
-    bool operator>=(const Str& other) const { 
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GE) == 1; 
-    }
+    out << "# HELP pyobj_references_total Reference traffic of pyobj handles\n"
+        << "# TYPE pyobj_references_total counter\n"
+        << "pyobj_references_total{kind=\"adopted\"} " << snapshot.handles_adopted << "\n"
+        << "pyobj_references_total{kind=\"taken\"} " << snapshot.references_taken << "\n"
+        << "pyobj_references_total{kind=\"released\"} " << snapshot.references_released << "\n";
+    
+    ArenaStats arena = arena_stats();
+    out << "# HELP pyobj_arena_bytes Allocator arena chunks in use and reserved\n"
+        << "# TYPE pyobj_arena_bytes gauge\n"
+        << "pyobj_arena_bytes{state=\"in_use\"} " << arena.chunks_in_use * arena.chunk_bytes << "\n"
+        << "pyobj_arena_bytes{state=\"reserved\"} " << arena.reserved_bytes << "\n";
+    
+    return out.str();
+}
 
-    // Contains check
-    bool contains(const Str& substring) const { 
-        int result = PySequence_Contains(obj, substring.get_obj()); 
-        return result == 1; 
+// ================== GIL Guards ==================
+// Takes the GIL for the current thread. Nests and works on threads that
+// Python has never seen.
+class gil_acquire {
+    PyGILState_STATE state{};
+    bool ensured;
+
+public:
+    gil_acquire() : ensured(!detail::owns_interpreter_gil()) { 
+        if (ensured) {
+            detail::ApiProbe<Api::GilWait> wait;
+            state = PyGILState_Ensure(); 
+        }
+    }
+    ~gil_acquire() { 
+        if (ensured) PyGILState_Release(state); 
     }
 
-    // String representation
-    std::string str() const {
-        if (!obj) return "None";
-        
-        PyObject* string_obj = PyObject_Str(obj);
-        if (!string_obj) return "None";
-        
-        const char* c_str = PyUnicode_AsUTF8(string_obj);
-        std::string result = c_str ? c_str : "";
-        Py_XDECREF(string_obj);
-        
-        return result;
+    gil_acquire(const gil_acquire&) = delete;
+    gil_acquire& operator=(const gil_acquire&) = delete;
+};
+
+// Lets other threads run Python while the current one stays in C++.
+// No Python objects may be touched until the guard goes out of scope.
+class gil_release {
+    PyThreadState* state;
+
+public:
+    gil_release() : state(PyEval_SaveThread()) {}
+    ~gil_release() { 
+        detail::ApiProbe<Api::GilWait> wait;
+        PyEval_RestoreThread(state); 
     }
+
+    gil_release(const gil_release&) = delete;
+    gil_release& operator=(const gil_release&) = delete;
 };
 
-// ================== List Class ==================
-class List : public PyObj {
+// ================== Error Handling ==================
+// A Python exception taken off the interpreter. The message is built on the
+// first what() and the traceback only by traceback_text(), so an error that
+// is just counted or dropped costs no formatting. Copies share the
+// exception; the GIL is taken as needed, so errors may outlive a GIL scope
+// (not their interpreter).
+class error : public std::exception {
+    PyObject* kind = nullptr;
+    PyObject* exc = nullptr;
+    PyObject* trace = nullptr;
+    mutable std::string message;
+
 public:
-    List() : PyObj(PyList_New(0)) {}
-    explicit List(PyObject* o) : PyObj(o) {}
+    error() = default;
     
-    List(const std::initializer_list<PyObj>& elements)
-        : PyObj(PyList_New(elements.size())) {
-        if (!obj) return;
-        
-        size_t index = 0;
-        for (const auto& value : elements) {
-            Py_XINCREF(value.get_obj());
-            PyList_SetItem(obj, index++, value.get_obj());
+    // Takes the exception currently set (GIL held); empty if none is
+    static error fetch() {
+        error e;
+#if PY_VERSION_HEX >= 0x030C0000
+        e.exc = PyErr_GetRaisedException();
+        if (e.exc) {
+            e.kind = reinterpret_cast<PyObject*>(Py_TYPE(e.exc));
+            Py_INCREF(e.kind);
+            e.trace = PyException_GetTraceback(e.exc);
         }
-    }
-
-    // List manipulation methods
-    void append(const PyObj& value) { 
-        PyList_Append(obj, value.get_obj()); 
+#else
+        PyErr_Fetch(&e.kind, &e.exc, &e.trace);
+        if (e.kind) {
+            PyErr_NormalizeException(&e.kind, &e.exc, &e.trace);
+            if (e.trace && e.exc) PyException_SetTraceback(e.exc, e.trace);
+        }
+#endif
+        return e;
     }
     
-    void extend(const List& other) {
-        PyObject* result = PyObject_CallMethod(obj, "extend", "O", other.get_obj());
-        Py_XDECREF(result);
+    // Once the interpreter is finalized the objects are gone: a copy keeps
+    // only the message, and the destructor leaves the pointers alone
+    error(const error& other) : message(other.message) {
+        if (!Py_IsInitialized()) return;
+        gil_acquire gil;
+        kind = other.kind;
+        exc = other.exc;
+        trace = other.trace;
+        Py_XINCREF(kind);
+        Py_XINCREF(exc);
+        Py_XINCREF(trace);
     }
     
-    void insert(long index, const PyObj& value) {
-        PyObject* result = PyObject_CallMethod(obj, "insert", "lO", index, value.get_obj());
-        Py_XDECREF(result);
+    error(error&& other) noexcept 
+        : kind(other.kind), exc(other.exc), trace(other.trace), message(std::move(other.message)) {
+        other.kind = other.exc = other.trace = nullptr;
     }
     
-    void remove(const PyObj& value) {
-        PyObject* result = PyObject_CallMethod(obj, "remove", "O", value.get_obj());
-        Py_XDECREF(result);
+    error& operator=(error other) noexcept {
+        std::swap(kind, other.kind);
+        std::swap(exc, other.exc);
+        std::swap(trace, other.trace);
+        std::swap(message, other.message);
+        return *this;
     }
     
-    PyObj pop(int index = -1) {
-        if (!obj) return PyObj();
-        
-        Py_ssize_t size = PyList_Size(obj);
-        if (index < 0) index += size;
-        if (index < 0 || index >= size) return PyObj();
-        
-        PyObject* item = PyList_GetItem(obj, index);
-        Py_XINCREF(item);
-        PySequence_DelItem(obj, index);
-        
-        return PyObj(item);
+    ~error() override {
+        if ((!kind && !exc && !trace) || !Py_IsInitialized()) return;
+        gil_acquire gil;
+        Py_XDECREF(kind);
+        Py_XDECREF(exc);
+        Py_XDECREF(trace);
     }
     
-    void clear() {
-        PyObject* result = PyObject_CallMethod(obj, "clear", nullptr);
-        Py_XDECREF(result);
+    explicit operator bool() const { return kind != nullptr; }
+    
+    // Borrowed references
+    PyObject* type() const { return kind; }
+    PyObject* value() const { return exc; }
+    PyObject* traceback() const { return trace; }
+    
+    // isinstance check against an exception class, e.g. PyExc_KeyError
+    bool matches(PyObject* exception_type) const {
+        return kind && PyErr_GivenExceptionMatches(kind, exception_type);
     }
     
-    long index(const PyObj& value) const {
-        PyObject* result = PyObject_CallMethod(obj, "index", "O", value.get_obj());
-        long index_value = result ? PyLong_AsLong(result) : -1;
-        Py_XDECREF(result);
+    // "TypeName: message"
+    const char* what() const noexcept override {
+        if (!message.empty() || !kind || !Py_IsInitialized()) return message.c_str();
         
-        return index_value;
+        gil_acquire gil;
+        message = reinterpret_cast<PyTypeObject*>(kind)->tp_name;
+        PyObject* text = exc ? PyObject_Str(exc) : nullptr;
+        const char* utf8 = text ? PyUnicode_AsUTF8(text) : nullptr;
+        if (utf8 && *utf8) message.append(": ").append(utf8);
+        Py_XDECREF(text);
+        if (!utf8) PyErr_Clear();
+        return message.c_str();
     }
     
-    long count(const PyObj& value) const {
-        PyObject* result = PyObject_CallMethod(obj, "count", "O", value.get_obj());
-        long count_value = result ? PyLong_AsLong(result) : 0;
-        Py_XDECREF(result);
+    // Formatted like an uncaught exception, traceback included
+    std::string traceback_text() const {
+        if (!kind) return std::string();
+        if (!Py_IsInitialized()) return std::string(what()) + "\n";
         
-        return count_value;
-    }
-    
-    void reverse() {
-        PyObject* result = PyObject_CallMethod(obj, "reverse", nullptr);
-        Py_XDECREF(result);
-    }
-    
-    void sort() {
-        PyObject* result = PyObject_CallMethod(obj, "sort", nullptr);
-        Py_XDECREF(result);
-    }
-
-    // Length and contains
-    long len() const { return obj ? PyList_Size(obj) : 0; }
-
-    bool contains(const PyObj& value) const {
-        if (!obj) return false;
+        gil_acquire gil;
+        std::string output;
+        PyObject* module = PyImport_ImportModule("traceback");
+        PyObject* lines = module 
+            ? PyObject_CallMethod(module, "format_exception", "OOO", kind, exc ? exc : Py_None, trace ? trace : Py_None) 
+            : nullptr;
+        PyObject* fast = lines ? PySequence_Fast(lines, "format_exception") : nullptr;
         
-        int result = PySequence_Contains(obj, value.get_obj());
-        if (result == -1) { 
-            PyErr_Clear(); 
-            return false; 
+        for (Py_ssize_t i = 0; fast && i < PySequence_Fast_GET_SIZE(fast); ++i) {
+            const char* line = PyUnicode_AsUTF8(PySequence_Fast_ITEMS(fast)[i]);
+            if (line) output += line;
         }
         
-        return result == 1;
+        Py_XDECREF(fast);
+        Py_XDECREF(lines);
+        Py_XDECREF(module);
+        if (PyErr_Occurred()) PyErr_Clear();
+        return output.empty() ? std::string(what()) + "\n" : output;
     }
-
-    // Indexing
-    PyObj operator[](long index) const {
-        if (!obj) return PyObj();
-        
-        Py_ssize_t size = PyList_Size(obj);
-        if (index < 0) index += size;
-        if (index < 0 || index >= size) return PyObj();
-        
-        PyObject* item = PyList_GetItem(obj, index);
-        Py_XINCREF(item);
-        
-        return PyObj(item);
+    
+    // Sets the exception again, e.g. to hand it back to Python code
+    void restore() const {
+        if (!kind) return;
+        Py_XINCREF(kind);
+        Py_XINCREF(exc);
+        Py_XINCREF(trace);
+        PyErr_Restore(kind, exc, trace);
     }
+};
 
-    bool set(long index, const PyObj& value) {
-        if (!obj) return false;
-        return PyList_SetItem(obj, index, value.get_obj()) == 0;
-    }
+// What the library does with a failed call that hands back an empty PyObj:
+// Print the traceback to stderr (the default), Throw a py::error, or Ignore
+// it. An ErrorBatch on the thread takes precedence and collects instead.
+enum class ErrorPolicy { Print, Throw, Ignore };
 
-    // List operations
-    List operator+(const List& other) const {
-        if (!obj || !other.get_obj()) return List();
-        
-        PyObject* result = PySequence_Concat(obj, other.get_obj());
-        return List(result);
-    }
+namespace detail {
+inline std::atomic<ErrorPolicy>& global_error_policy() {
+    static std::atomic<ErrorPolicy> policy{ ErrorPolicy::Print };
+    return policy;
+}
 
-    List& operator+=(const List& other) {
-        extend(other);
-        return *this;
-    }
+struct ThreadErrors {
+    bool overridden = false;
+    ErrorPolicy policy = ErrorPolicy::Print;
+    std::vector<error>* batch = nullptr;
+};
 
-    List operator*(long n) const {
-        if (!obj) return List();
-        
-        PyObject* result = PySequence_Repeat(obj, n);
-        return List(result);
-    }
+inline ThreadErrors& thread_errors() {
+    thread_local ThreadErrors state;
+    return state;
+}
+} // end namespace detail
 
-    List& operator*=(long n) {
-        PyObject* result = PySequence_Repeat(obj, n);
-        if (result) {
-            Py_XDECREF(obj);
-            obj = result;
-        }
-        return *this;
-    }
+inline void set_error_policy(ErrorPolicy policy) {
+    detail::global_error_policy().store(policy, std::memory_order_relaxed);
+}
 
-    // Comparison operators
-    bool operator==(const List& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_EQ) == 1;
+inline ErrorPolicy error_policy() {
+    detail::ThreadErrors& state = detail::thread_errors();
+    return state.overridden ? state.policy : detail::global_error_policy().load(std::memory_order_relaxed);
+}
+
+// Overrides the policy for the current thread while in scope
+class ErrorPolicyScope {
+    detail::ThreadErrors saved;
+
+public:
+    explicit ErrorPolicyScope(ErrorPolicy policy) : saved(detail::thread_errors()) {
+        detail::thread_errors().overridden = true;
+        detail::thread_errors().policy = policy;
     }
-    
-    bool operator!=(const List& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_NE) == 1;
+    ~ErrorPolicyScope() {
+        detail::thread_errors().overridden = saved.overridden;
+        detail::thread_errors().policy = saved.policy;
     }
+
+    ErrorPolicyScope(const ErrorPolicyScope&) = delete;
+    ErrorPolicyScope& operator=(const ErrorPolicyScope&) = delete;
+};
+
+// Collects the errors raised on this thread while in scope, for bulk work
+// that should neither print nor stop at the first bad item. Nests.
+class ErrorBatch {
+    std::vector<error> collected;
+    std::vector<error>* previous;
+
+public:
+    ErrorBatch() : previous(detail::thread_errors().batch) { detail::thread_errors().batch = &collected; }
+    ~ErrorBatch() { detail::thread_errors().batch = previous; }
+
+    ErrorBatch(const ErrorBatch&) = delete;
+    ErrorBatch& operator=(const ErrorBatch&) = delete;
+
+    bool empty() const { return collected.empty(); }
+    size_t size() const { return collected.size(); }
+    const std::vector<error>& errors() const { return collected; }
+    std::vector<error> take() { return std::move(collected); }
+    void clear() { collected.clear(); }
+};
+
+namespace detail {
+// Called where a failed call leaves an exception set
+inline void report_error() {
+    if (!PyErr_Occurred()) return;
     
-    bool operator<(const List& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LT) == 1;
+    ThreadErrors& state = thread_errors();
+    if (state.batch) {
+        state.batch->push_back(error::fetch());
+        return;
     }
     
-    bool operator<=(const List& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LE) == 1;
+    switch (error_policy()) {
+        case ErrorPolicy::Print: PyErr_Print(); return;
+        case ErrorPolicy::Ignore: PyErr_Clear(); return;
+        case ErrorPolicy::Throw: throw error::fetch();
     }
+}
+
+// Reports a failure that has no Python exception of its own
+inline void report_error(PyObject* exception_type, const char* text) {
+    PyErr_SetString(exception_type, text);
+    report_error();
+}
+} // end namespace detail
+
+// Either a value or the error that replaced it, without throwing
+template<typename T>
+class expected {
+    std::optional<T> stored;
+    py::error failure;
+
+public:
+    expected(T value) : stored(std::move(value)) {}
+    expected(py::error e) : failure(std::move(e)) {}
     
-    bool operator>(const List& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GT) == 1;
-    }
+    bool has_value() const { return stored.has_value(); }
+    explicit operator bool() const { return has_value(); }
     
-    bool operator>=(const List& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GE) == 1;
+    // Throws the error when there is no value
+    T& value() & {
+        if (!stored) throw failure;
+        return *stored;
     }
-
-    // String representation
-    std::string str() const {
-        if (!obj) return "None";
-        
-        PyObject* string_obj = PyObject_Str(obj);
-        if (!string_obj) return "None";
-        
-        const char* c_str = PyUnicode_AsUTF8(string_obj);
-        std::string result = c_str ? c_str : "";
-        Py_XDECREF(string_obj);
-        
-        return result;
+    const T& value() const & {
+        if (!stored) throw failure;
+        return *stored;
     }
+    T value_or(T fallback) const { return stored ? *stored : std::move(fallback); }
+    
+    const py::error& error() const { return failure; }
+    
+    T& operator*() { return *stored; }
+    const T& operator*() const { return *stored; }
+    T* operator->() { return &*stored; }
+    const T* operator->() const { return &*stored; }
 };
 
-// ================== Tuple Class ==================
-class Tuple : public PyObj {
-public:
-    Tuple() : PyObj(PyTuple_New(0)) {}
-    explicit Tuple(PyObject* o) : PyObj(o) {}
-    
-    Tuple(const std::initializer_list<PyObj>& elements) {
-        PyObject* tuple = PyTuple_New(elements.size());
-        if (!tuple) {
-            obj = nullptr;
-            return;
-        }
-        
-        size_t index = 0;
-        for (auto& value : elements) {
-            Py_XINCREF(value.get_obj());
-            PyTuple_SetItem(tuple, index++, value.get_obj());
-        }
-        obj = tuple;
-    }
+// Runs f and returns its result, or the first Python error it reported:
+// attempt([&] { return eval_expr(code); })
+template<typename F>
+auto attempt(F&& function) -> expected<std::decay_t<decltype(function())>> {
+    ErrorBatch batch;
+    auto result = function();
+    if (!batch.empty()) return batch.take().front();
+    return result;
+}
 
-    // Basic operations
-    long len() const { return obj ? PyTuple_Size(obj) : 0; }
+// ================== Reference Ownership Tags ==================
+// steal() hands a new reference over to the wrapper, borrow() makes the
+// wrapper take its own reference. A raw PyObject* is treated as borrowed.
+struct stolen_ref { PyObject* ptr; };
+struct borrowed_ref { PyObject* ptr; };
 
-    PyObj operator[](long index) const {
-        if (!obj) return PyObj();
-        
-        Py_ssize_t size = PyTuple_Size(obj);
-        if (index < 0) index += size;
-        if (index < 0 || index >= size) return PyObj();
-        
-        PyObject* item = PyTuple_GetItem(obj, index);
-        Py_XINCREF(item);
-        
-        return PyObj(item);
-    }
+inline stolen_ref steal(PyObject* o) { return {o}; }
+inline borrowed_ref borrow(PyObject* o) { return {o}; }
 
-    long index(const PyObj& value) const {
-        if (!obj) return -1;
-        
-        Py_ssize_t idx = PySequence_Index(obj, value.get_obj());
-        if (idx == -1 && PyErr_Occurred()) { 
-            PyErr_Clear(); 
-            return -1; 
-        }
-        
-        return idx;
+// ================== String Views ==================
+namespace detail {
+// UTF-8 contents of a str without copying. ASCII strings are read straight
+// from PyUnicode_DATA, anything else from the UTF-8 buffer CPython caches
+// on the object. Valid while the object lives.
+inline std::string_view unicode_view(PyObject* o) {
+    if (!o || !PyUnicode_Check(o)) return {};
+    
+    if (PyUnicode_IS_ASCII(o)) 
+        return { static_cast<const char*>(PyUnicode_DATA(o)), static_cast<size_t>(PyUnicode_GET_LENGTH(o)) };
+    
+    Py_ssize_t size = 0;
+    const char* data = PyUnicode_AsUTF8AndSize(o, &size);
+    if (!data) { 
+        PyErr_Clear(); 
+        return {}; 
     }
+    return { data, static_cast<size_t>(size) };
+}
 
-    long count(const PyObj& value) const {
-        if (!obj) return 0;
+// Compares a str to UTF-8 text. ASCII and latin-1 strings are compared in
+// place, so no UTF-8 copy gets attached to them.
+inline bool unicode_equals(PyObject* o, std::string_view text) {
+    if (!o || !PyUnicode_Check(o)) return false;
+    
+    if (PyUnicode_IS_ASCII(o)) 
+        return unicode_view(o) == text;
+    
+    if (PyUnicode_KIND(o) == PyUnicode_1BYTE_KIND) {
+        const Py_UCS1* data = PyUnicode_1BYTE_DATA(o);
+        Py_ssize_t length = PyUnicode_GET_LENGTH(o);
+        size_t pos = 0;
         
-        Py_ssize_t count_value = PySequence_Count(obj, value.get_obj());
-        if (count_value == -1 && PyErr_Occurred()) { 
-            PyErr_Clear(); 
-            return 0; 
+        for (Py_ssize_t i = 0; i < length; ++i) {
+            if (pos >= text.size()) return false;
+            
+            unsigned char c = static_cast<unsigned char>(text[pos]);
+            if (data[i] < 0x80) {
+                if (c != data[i]) return false;
+                ++pos;
+            } else {
+                // U+0080..U+00FF is always two bytes in UTF-8
+                if (pos + 1 >= text.size() || c != (0xC0 | (data[i] >> 6)) ||
+                    static_cast<unsigned char>(text[pos + 1]) != (0x80 | (data[i] & 0x3F)))
+                    return false;
+                pos += 2;
+            }
         }
-        
-        return count_value;
+        return pos == text.size();
     }
+    
+    return unicode_view(o) == text;
+}
+} // end namespace detail
 
-    bool contains(const PyObj& value) const {
-        if (!obj) return false;
-        
-        int result = PySequence_Contains(obj, value.get_obj());
-        if (result == -1) { 
-            PyErr_Clear(); 
-            return false; 
-        }
-        
-        return result == 1;
-    }
+class Method;
+class PyObj;
 
-    // Tuple operations
-    Tuple operator+(const Tuple& other) const {
-        if (!obj || !other.get_obj()) return Tuple();
-        
-        PyObject* result = PySequence_Concat(obj, other.get_obj());
-        return Tuple(result);
-    }
+// ================== Handle Relocation ==================
+// True for types that can be moved to a new address with memcpy, leaving
+// the old bytes unused without running their destructor. Holds for PyObj
+// and every typed handle that keeps its single pointer.
+template<typename T, typename Enable = void>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
 
-    Tuple operator*(long n) const {
-        if (!obj) return Tuple();
-        
-        PyObject* result = PySequence_Repeat(obj, n);
-        return Tuple(result);
-    }
+template<typename T>
+struct is_trivially_relocatable<T, std::enable_if_t<std::is_base_of_v<PyObj, T> && sizeof(T) == sizeof(PyObject*)>> 
+    : std::true_type {};
 
-    // Comparison operators
-    bool operator==(const Tuple& other) const {
-        if (!obj || !other.get_obj()) return false;
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_EQ) == 1;
-    }
+namespace detail {
+// A slot holding a PyObject* read in place as a borrowed handle: PyObj is
+// exactly that one pointer, so container items need no incref to be viewed
+inline const PyObj* as_handles(PyObject* const* items) {
+    return reinterpret_cast<const PyObj*>(items);
+}
 
-    bool operator!=(const Tuple& other) const {
-        if (!obj || !other.get_obj()) return true;
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_NE) == 1;
-    }
+// Defined with the native conversions
+template<typename T, typename Enable = void>
+struct Converter;
+} // end namespace detail
 
-    bool operator<(const Tuple& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LT) == 1;
+// ================== Base PyObj Class ==================
+// A handle is exactly one owned PyObject*, with no vtable. The typed
+// classes below add only behaviour; a subclass that added members would
+// no longer count as trivially relocatable. Nothing deletes handles
+// through a base pointer, so the destructor is not virtual.
+class PyObj {
+protected:
+    PyObject* obj;
+
+public:
+    // Constructors
+    PyObj(PyObject* o = nullptr) : obj(o) { Py_XINCREF(obj); detail::note_taken(obj); }
+    PyObj(const PyObj& other) : obj(other.obj) { Py_XINCREF(obj); detail::note_taken(obj); }
+    PyObj(PyObj&& other) noexcept : obj(other.obj) { other.obj = nullptr; }
+    PyObj(stolen_ref r) : obj(r.ptr) { detail::note_adopted(obj); }
+    PyObj(borrowed_ref r) : obj(r.ptr) { Py_XINCREF(obj); detail::note_taken(obj); }
+    
+    // Type conversion constructors
+    PyObj(int v) : obj(PyLong_FromLong(v)) { detail::note_adopted(obj); }
+    PyObj(long v) : obj(PyLong_FromLong(v)) { detail::note_adopted(obj); }
+    PyObj(double v) : obj(PyFloat_FromDouble(v)) { detail::note_adopted(obj); }
+    PyObj(bool v) : obj(v ? Py_True : Py_False) { Py_XINCREF(obj); detail::note_taken(obj); }
+    PyObj(const std::string& s) : obj(PyUnicode_FromStringAndSize(s.data(), s.size())) { detail::note_adopted(obj); }
+    PyObj(std::string_view s) : obj(PyUnicode_FromStringAndSize(s.data(), s.size())) { detail::note_adopted(obj); }
+    PyObj(const char* s) : obj(PyUnicode_FromString(s)) { detail::note_adopted(obj); }
+
+    // Assignment operators
+    PyObj& operator=(const PyObj& other) {
+        if (this != &other) {
+            detail::note_released(obj);
+            Py_XDECREF(obj);
+            obj = other.obj;
+            Py_XINCREF(obj);
+            detail::note_taken(obj);
+        }
+        return *this;
     }
 
-    bool operator<=(const Tuple& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LE) == 1;
+    PyObj& operator=(PyObj&& other) noexcept {
+        if (this != &other) {
+            detail::note_released(obj);
+            Py_XDECREF(obj);
+            obj = other.obj;
+            other.obj = nullptr;
+        }
+        return *this;
     }
 
-    bool operator>(const Tuple& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GT) == 1;
+    // Handles that outlive exit_python() have nothing left to release
+    ~PyObj() { 
+        if (Py_IsInitialized()) {
+            detail::note_released(obj);
+            Py_XDECREF(obj); 
+        }
     }
+    
+    // Getters
+    PyObject* get_obj() const { return obj; }
 
-    bool operator>=(const Tuple& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GE) == 1;
+    // Gives up ownership, the caller becomes responsible for the reference
+    PyObject* release() {
+        PyObject* o = obj;
+        obj = nullptr;
+        return o;
+    }
+
+    // Type checking methods
+    bool is_empty() const {
+        if (!obj) return true;
+        if (PyUnicode_Check(obj)) return PyUnicode_GetLength(obj) == 0;
+        if (PyList_Check(obj)) return PyList_Size(obj) == 0;
+        if (PyDict_Check(obj)) return PyDict_Size(obj) == 0;
+        if (PySet_Check(obj)) return PySet_Size(obj) == 0;
+        return false;
+    }
+
+    bool is_dict() const { return obj && PyDict_Check(obj); }
+    bool is_list() const { return obj && PyList_Check(obj); }
+    bool is_tuple() const { return obj && PyTuple_Check(obj); }
+    bool is_str() const { return obj && PyUnicode_Check(obj); }
+    bool is_set() const { return obj && PySet_Check(obj); }
+    bool is_sequence() const { return is_list() || is_tuple() || is_str(); }
+    bool is_callable() const { return obj && PyCallable_Check(obj); }
+
+    // Item access methods
+    PyObj get_item(const PyObj& key) const {
+        if (!obj) return PyObj();
+        
+        if (PyDict_Check(obj)) 
+            return PyObj(borrow(PyDict_GetItem(obj, key.get_obj())));
+            
+        PyObject* result = PyObject_GetItem(obj, key.get_obj());
+        if (!result) { 
+            PyErr_Clear(); 
+            return PyObj(); 
+        }
+        
+        return PyObj(steal(result));
+    }
+
+    PyObj get_item(long index) const {
+        if (!obj) return PyObj();
+
+        // Handle lists and tuples
+        if (PyList_Check(obj) || PyTuple_Check(obj)) {
+            Py_ssize_t size = PyList_Check(obj) 
+                ? PyList_Size(obj) 
+                : PyTuple_Size(obj);
+                
+            if (index < 0) index += size;
+            if (index < 0 || index >= size) return PyObj();
+            
+            PyObject* item = PyList_Check(obj) 
+                ? PyList_GetItem(obj, index) 
+                : PyTuple_GetItem(obj, index);
+                
+            return PyObj(borrow(item));
+        }
+
+        // Handle strings
+        if (PyUnicode_Check(obj)) {
+            Py_ssize_t length = PyUnicode_GetLength(obj);
+            if (index < 0) index += length;
+            if (index < 0 || index >= length) return PyObj();
+            
+            Py_UCS4 character = PyUnicode_ReadChar(obj, index);
+            return PyObj(steal(PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, &character, 1)));
+        }
+
+        // Generic case
+        PyObject* py_index = PyLong_FromLong(index);
+        PyObject* result = PyObject_GetItem(obj, py_index);
+        Py_XDECREF(py_index);
+        
+        if (!result) { 
+            PyErr_Clear(); 
+            return PyObj(); 
+        }
+        
+        return PyObj(steal(result));
+    }
+
+    // Operator overloads for item access
+    PyObj operator[](const PyObj& key) const { return get_item(key); }
+    PyObj operator[](long index) const { return get_item(index); }
+
+    // Item setting methods
+    bool set_item(const PyObj& key, const PyObj& value) {
+        if (!obj) return false;
+        
+        return PyDict_Check(obj) 
+            ? PyDict_SetItem(obj, key.get_obj(), value.get_obj()) == 0
+            : PyObject_SetItem(obj, key.get_obj(), value.get_obj()) == 0;
+    }
+
+    bool set_item(long index, const PyObj& value) {
+        if (!obj) return false;
+        
+        if (PyList_Check(obj)) {
+            Py_ssize_t size = PyList_Size(obj); 
+            if (index < 0) index += size;
+            if (index < 0 || index >= size) return false;
+            
+            Py_XINCREF(value.get_obj());
+            return PyList_SetItem(obj, index, value.get_obj()) == 0;
+        }
+        
+        PyObject* py_index = PyLong_FromLong(index);
+        int success = PyObject_SetItem(obj, py_index, value.get_obj());
+        Py_XDECREF(py_index);
+        
+        return success == 0;
+    }
+
+    // ===== UNIVERSAL operator () for any type =====
+    template<typename... Args>
+    PyObj operator()(Args&&... args) const {
+        if (!obj || !PyCallable_Check(obj)) {
+            detail::report_error(PyExc_TypeError, "object is not callable");
+            return PyObj();
+        }
+
+        // Arguments go into a stack array, slot 0 stays free for the callee
+        // (PY_VECTORCALL_ARGUMENTS_OFFSET)
+        constexpr size_t count = sizeof...(Args);
+        PyObject* stack[count + 1] = { nullptr, convert_to_pyobject(std::forward<Args>(args))... };
+        
+        bool converted = true;
+        for (size_t i = 1; i <= count; ++i) converted = converted && stack[i];
+        
+        PyObject* result = converted 
+            ? PyObject_Vectorcall(obj, stack + 1, count | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr)
+            : nullptr;
+            
+        for (size_t i = 1; i <= count; ++i) Py_XDECREF(stack[i]);
+        
+        if (!result) {
+            detail::report_error();
+            return PyObj();
+        }
+        return PyObj(steal(result));
+    }
+
+    // Bound method resolved once, for calling the same method repeatedly
+    Method method(const std::string& name) const;
+
+    // String representation
+    std::string str() const {
+        if (!obj) return "None";
+        if (PyUnicode_CheckExact(obj)) return std::string(detail::unicode_view(obj));
+        
+        PyObject* string_obj = PyObject_Str(obj);
+        if (!string_obj) { 
+            PyErr_Clear(); 
+            return "<error>"; 
+        }
+        
+        const char* c_str = PyUnicode_AsUTF8(string_obj);
+        std::string result = c_str ? c_str : "";
+        Py_XDECREF(string_obj);
+        
+        return result;
+    }
+
+    // Pretty printing
+    static void pretty_print(std::ostream& os, const PyObj& obj, int indent = 0);
+
+private:
+    // Helper methods for argument conversion
+    PyObject* convert_to_pyobject(const PyObj& arg) const {
+        Py_XINCREF(arg.get_obj());
+        return arg.get_obj();
+    }
+    
+    PyObject* convert_to_pyobject(int arg) const {
+        return PyLong_FromLong(arg);
+    }
+    
+    PyObject* convert_to_pyobject(long arg) const {
+        return PyLong_FromLong(arg);
+    }
+    
+    PyObject* convert_to_pyobject(double arg) const {
+        return PyFloat_FromDouble(arg);
+    }
+    
+    PyObject* convert_to_pyobject(bool arg) const {
+        return PyBool_FromLong(arg);
+    }
+    
+    PyObject* convert_to_pyobject(const std::string& arg) const {
+        return PyUnicode_FromString(arg.c_str());
+    }
+    
+    PyObject* convert_to_pyobject(const char* arg) const {
+        return PyUnicode_FromString(arg);
+    }
+};
+
+// PYOBJ_STD_RELOCATE opts into libstdc++'s internal relocation trait, so a
+// growing std::vector of handles moves with one memmove instead of a move
+// and a destructor call per element. The trait is a reserved name that a
+// later libstdc++ may change or drop, hence off by default; it has to be
+// seen before any vector of handles is instantiated, which is why it sits
+// right after PyObj.
+#if defined(PYOBJ_STD_RELOCATE) && defined(__GLIBCXX__) && defined(_GLIBCXX_RELEASE) && _GLIBCXX_RELEASE >= 9
+} // end namespace py
+
+namespace std {
+template<typename T>
+struct __is_bitwise_relocatable<T, enable_if_t<py::is_trivially_relocatable<T>::value && !is_trivial<T>::value>> 
+    : true_type {};
+}
+
+namespace py {
+#endif
+
+// ================== String Class ==================
+class Str : public PyObj {
+public:
+    // Constructors
+    Str() : PyObj("") {}
+    Str(const std::string& s) : PyObj(s) {}
+    Str(std::string_view s) : PyObj(s) {}
+    Str(const char* s) : PyObj(s) {}
+    Str(PyObject* o) : PyObj(o) {}
+    Str(stolen_ref r) : PyObj(r) {}
+    Str(borrowed_ref r) : PyObj(r) {}
+    Str(const PyObj& o) : PyObj(o.get_obj()) {}
+
+    // String manipulation methods
+    Str capitalize() const { 
+        PyObject* result = method("capitalize"); 
+        return Str(steal(result)); 
+    }
+    
+    Str upper() const { 
+        PyObject* result = method("upper"); 
+        return Str(steal(result)); 
+    }
+    
+    Str lower() const { 
+        PyObject* result = method("lower"); 
+        return Str(steal(result)); 
+    }
+    
+    Str title() const { 
+        PyObject* result = method("title"); 
+        return Str(steal(result)); 
+    }
+    
+    Str swapcase() const { 
+        PyObject* result = method("swapcase"); 
+        return Str(steal(result)); 
+    }
+    
+    Str strip() const { 
+        PyObject* result = method("strip"); 
+        return Str(steal(result)); 
+    }
+    
+    Str lstrip() const { 
+        PyObject* result = method("lstrip"); 
+        return Str(steal(result)); 
+    }
+    
+    Str rstrip() const { 
+        PyObject* result = method("rstrip"); 
+        return Str(steal(result)); 
+    }
+
+    // String validation methods
+    bool isdigit() const { 
+        PyObject* result = method("isdigit"); 
+        bool value = result && PyObject_IsTrue(result); 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    bool isalpha() const { 
+        PyObject* result = method("isalpha"); 
+        bool value = result && PyObject_IsTrue(result); 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    bool isalnum() const { 
+        PyObject* result = method("isalnum"); 
+        bool value = result && PyObject_IsTrue(result); 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    bool isdecimal() const { 
+        PyObject* result = method("isdecimal"); 
+        bool value = result && PyObject_IsTrue(result); 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    bool isnumeric() const { 
+        PyObject* result = method("isnumeric"); 
+        bool value = result && PyObject_IsTrue(result); 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    bool istitle() const { 
+        PyObject* result = method("istitle"); 
+        bool value = result && PyObject_IsTrue(result); 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    bool isupper() const { 
+        PyObject* result = method("isupper"); 
+        bool value = result && PyObject_IsTrue(result); 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    bool islower() const { 
+        PyObject* result = method("islower"); 
+        bool value = result && PyObject_IsTrue(result); 
+        Py_XDECREF(result); 
+        return value; 
+    }
+
+    // Search methods
+    long find(const Str& substring) const { 
+        PyObject* result = method("find", substring.get_obj()); 
+        long value = result ? PyLong_AsLong(result) : -1; 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    long rfind(const Str& substring) const { 
+        PyObject* result = method("rfind", substring.get_obj()); 
+        long value = result ? PyLong_AsLong(result) : -1; 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    long index(const Str& substring) const { 
+        PyObject* result = method("index", substring.get_obj()); 
+        long value = result ? PyLong_AsLong(result) : -1; 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    long rindex(const Str& substring) const { 
+        PyObject* result = method("rindex", substring.get_obj()); 
+        long value = result ? PyLong_AsLong(result) : -1; 
+        Py_XDECREF(result); 
+        return value; 
+    }
+    
+    Str replace(const Str& old_str, const Str& new_str) const { 
+        PyObject* result = method("replace", old_str.get_obj(), new_str.get_obj()); 
+        return Str(steal(result)); 
+    }
+
+    // Split and join methods
+    std::vector<Str> split(const Str& separator = "") const {
+        detail::ApiProbe<Api::StrSplit> probe;
+        PyObject* result = separator.len() == 0 
+            ? detail::call_method(obj, "split") 
+            : detail::call_method(obj, "split", separator.get_obj());
+            
+        std::vector<Str> output;
+        if (!result) { 
+            PyErr_Clear(); 
+            return output; 
+        }
+        
+        if (PyList_Check(result)) {
+            Py_ssize_t size = PyList_Size(result);
+            for (Py_ssize_t i = 0; i < size; ++i) {
+                output.emplace_back(borrow(PyList_GetItem(result, i))); 
+            }
+        }
+        
+        Py_XDECREF(result);
+        return output;
+    }
+
+    Str join(const std::vector<Str>& sequence) const {
+        detail::ApiProbe<Api::StrJoin> probe;
+        PyObject* list_obj = PyList_New(sequence.size());
+        if (!list_obj) return Str();
+        
+        for (Py_ssize_t i = 0; i < sequence.size(); ++i) {
+            Py_XINCREF(sequence[i].get_obj()); 
+            PyList_SetItem(list_obj, i, sequence[i].get_obj()); 
+        }
+        
+        PyObject* result = detail::call_method(obj, "join", list_obj);
+        Py_XDECREF(list_obj);
+        
+        return Str(steal(result));
+    }
+
+    // Length and indexing
+    long len() const { return obj ? PyUnicode_GetLength(obj) : 0; }
+
+    Str operator[](long index) const {
+        Py_ssize_t length = len(); 
+        if (index < 0) index += length; 
+        if (index < 0 || index >= length) return Str();
+        
+        Py_UCS4 character = PyUnicode_ReadChar(obj, index);
+        return Str(steal(PyUnicode_FromKindAndData(PyUnicode_4BYTE_KIND, &character, 1)));
+    }
+
+    // String concatenation and repetition
+    Str operator+(const Str& other) const {
+        PyObject* result = PyUnicode_Concat(obj, other.get_obj());
+        return Str(steal(result));
+    }
+
+    Str& operator+=(const Str& other) {
+        PyObject* result = PyUnicode_Concat(obj, other.get_obj());
+        if (result) { 
+            Py_XDECREF(obj); 
+            obj = result; 
+        }
+        return *this;
+    }
+
+    Str operator*(long n) const {
+        PyObject* result = PySequence_Repeat(obj, n);
+        return Str(steal(result));
+    }
+
+    Str& operator*=(long n) {
+        PyObject* result = PySequence_Repeat(obj, n);
+        if (result) { 
+            Py_XDECREF(obj); 
+            obj = result; 
+        }
+        return *this;
+    }
+
+    // Comparison operators
+    bool operator==(const Str& other) const { 
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_EQ) == 1; 
+    }
+    
+    bool operator!=(const Str& other) const { 
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_NE) == 1; 
+    }
+    
+    bool operator<(const Str& other) const { 
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LT) == 1; 
+    }
+    
+    bool operator>(const Str& other) const { 
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GT) == 1; 
+    }
+    
+    bool operator<=(const Str& other) const { 
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LE) == 1; 
+    }
+    
+    bool operator>=(const Str& other) const { 
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GE) == 1; 
+    }
+
+    // Comparison with C++ text, without building a Python string
+    bool operator==(std::string_view text) const { return detail::unicode_equals(obj, text); }
+    bool operator==(const std::string& text) const { return detail::unicode_equals(obj, text); }
+    bool operator==(const char* text) const { return detail::unicode_equals(obj, text); }
+    bool operator!=(std::string_view text) const { return !detail::unicode_equals(obj, text); }
+    bool operator!=(const std::string& text) const { return !detail::unicode_equals(obj, text); }
+    bool operator!=(const char* text) const { return !detail::unicode_equals(obj, text); }
+
+    // Contains check
+    bool contains(const Str& substring) const { 
+        int result = PySequence_Contains(obj, substring.get_obj()); 
+        return result == 1; 
+    }
+
+    // Zero-copy UTF-8 view, valid while this Str is alive
+    std::string_view view() const { return detail::unicode_view(obj); }
+
+    bool is_ascii() const { return obj && PyUnicode_Check(obj) && PyUnicode_IS_ASCII(obj); }
+
+    // String representation
+    std::string str() const {
+        if (!obj) return "None";
+        if (PyUnicode_CheckExact(obj)) return std::string(view());
+        
+        PyObject* string_obj = PyObject_Str(obj);
+        if (!string_obj) return "None";
+        
+        const char* c_str = PyUnicode_AsUTF8(string_obj);
+        std::string result = c_str ? c_str : "";
+        Py_XDECREF(string_obj);
+        
+        return result;
+    }
+
+private:
+    template<typename... Objects>
+    PyObject* method(const char* name, Objects... args) const {
+        detail::ApiProbe<Api::StrMethod> probe;
+        return detail::call_method(obj, name, args...);
+    }
+};
+
+// ================== Sorting ==================
+namespace detail {
+// list.sort(key=key, reverse=reverse); false with the error cleared
+inline bool sort_list(PyObject* list, PyObject* key, bool reverse) {
+    if (!list) return false;
+    if ((!key || key == Py_None) && !reverse) {
+        if (PyList_Sort(list) == 0) return true;
+        PyErr_Clear();
+        return false;
+    }
+    
+    PyObject* sort = PyObject_GetAttrString(list, "sort");
+    PyObject* args = PyTuple_New(0);
+    PyObject* kwargs = PyDict_New();
+    PyObject* result = nullptr;
+    if (sort && args && kwargs &&
+        PyDict_SetItemString(kwargs, "key", key ? key : Py_None) == 0 &&
+        PyDict_SetItemString(kwargs, "reverse", reverse ? Py_True : Py_False) == 0)
+        result = PyObject_Call(sort, args, kwargs);
+    
+    Py_XDECREF(sort);
+    Py_XDECREF(args);
+    Py_XDECREF(kwargs);
+    if (!result) {
+        PyErr_Clear();
+        return false;
+    }
+    Py_DECREF(result);
+    return true;
+}
+
+// Strict weak order on native keys; NaN sorts after every number
+template<typename T>
+inline bool key_less(const T& a, const T& b) {
+    if constexpr (std::is_floating_point_v<T>) 
+        return a < b || (std::isnan(b) && !std::isnan(a));
+    else 
+        return a < b;
+}
+
+// Decorate-sort-undecorate: the keys are pulled once into a contiguous
+// array, sorted natively with the original index breaking ties (so the
+// sort stays stable, reverse included), and the item pointers permuted.
+// The extractor is a Python callable whose results convert to T, or a C++
+// callable taking const PyObj& returning T.
+template<typename T, typename F>
+bool sort_by_key(PyObject* list, F& extractor, bool reverse) {
+    if (!list || !PyList_Check(list)) return false;
+    
+    struct Entry {
+        T key;
+        Py_ssize_t index;
+    };
+    
+    Py_ssize_t size = PyList_GET_SIZE(list);
+    std::vector<Entry> entries;
+    entries.reserve(size);
+    
+    for (Py_ssize_t i = 0; i < size; ++i) {
+        // The extractor may run Python code that shrinks the list
+        if (PyList_GET_SIZE(list) != size) return false;
+        PyObject* item = PyList_GET_ITEM(list, i);
+        
+        if constexpr (std::is_base_of_v<PyObj, std::decay_t<F>>) {
+            PyObject* stack[2] = { nullptr, item };
+            Py_INCREF(item);
+            PyObject* key = PyObject_Vectorcall(extractor.get_obj(), stack + 1, 1 | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr);
+            Py_DECREF(item);
+            
+            T value{};
+            bool converted = key && Converter<T>::from(key, value);
+            Py_XDECREF(key);
+            if (!converted) {
+                PyErr_Clear();
+                return false;
+            }
+            entries.push_back(Entry{ std::move(value), i });
+        } else {
+            entries.push_back(Entry{ static_cast<T>(extractor(*as_handles(&item))), i });
+        }
+    }
+    
+    auto order = [reverse](const Entry& a, const Entry& b) {
+        if (key_less(a.key, b.key)) return !reverse;
+        if (key_less(b.key, a.key)) return reverse;
+        return a.index < b.index;
+    };
+    if constexpr (std::is_arithmetic_v<T> || std::is_same_v<T, std::string>) {
+        static_assert(!std::is_base_of_v<PyObj, T>, "sort_by_key: handle keys cannot be sorted without the GIL");
+        
+        // Native keys need no GIL; tiny lists are not worth the switch
+        std::optional<gil_release> released;
+        if (size >= 65536) released.emplace();
+#if defined(PYOBJ_PARALLEL_SORT)
+        if constexpr (std::is_arithmetic_v<T>) 
+            std::sort(std::execution::par_unseq, entries.begin(), entries.end(), order);
+        else
+            std::sort(std::execution::par, entries.begin(), entries.end(), order);
+#else
+        std::sort(entries.begin(), entries.end(), order);
+#endif
+    } else {
+        // Other keys (handles among them) may compare through Python, so
+        // they sort on this thread with the GIL held
+        std::sort(entries.begin(), entries.end(), order);
+    }
+    
+    if (PyList_GET_SIZE(list) != size) return false;
+    PyObject** items = reinterpret_cast<PyListObject*>(list)->ob_item;
+    std::vector<PyObject*> permuted(size);
+    for (Py_ssize_t i = 0; i < size; ++i) permuted[i] = items[entries[i].index];
+    std::copy(permuted.begin(), permuted.end(), items);
+    return true;
+}
+} // end namespace detail
+
+// ================== Item Scans ==================
+// all/any and count/index walk the item array of a list or tuple directly and
+// settle the exact int/float/bool/str cases without a method call or rich
+// comparison; anything else falls back to PyObject_IsTrue/RichCompareBool.
+namespace detail {
+inline int item_truth(PyObject* item) {
+    if (item == Py_True) return 1;
+    if (item == Py_False || item == Py_None) return 0;
+    if (PyLong_CheckExact(item)) {
+#if PY_VERSION_HEX >= 0x030C0000
+        if (PyUnstable_Long_IsCompact(reinterpret_cast<PyLongObject*>(item))) 
+            return PyUnstable_Long_CompactValue(reinterpret_cast<PyLongObject*>(item)) != 0;
+#else
+        return Py_SIZE(item) != 0;
+#endif
+    }
+    if (PyFloat_CheckExact(item)) return PyFloat_AS_DOUBLE(item) != 0.0;
+    if (PyUnicode_CheckExact(item)) return PyUnicode_GET_LENGTH(item) != 0;
+    return PyObject_IsTrue(item);
+}
+
+// Equality with one value, its native form worked out once
+class ItemMatcher {
+    PyObject* value;
+    PyTypeObject* type;
+    long long number = 0;
+    bool native_number = false;
+
+public:
+    explicit ItemMatcher(PyObject* value) : value(value), type(Py_TYPE(value)) {
+        if (type == &PyLong_Type) {
+            int overflow = 0;
+            number = PyLong_AsLongLongAndOverflow(value, &overflow);
+            native_number = !overflow && !(number == -1 && PyErr_Occurred());
+            if (!native_number) PyErr_Clear();
+        }
+    }
+    
+    // 1 on a match, 0 if not, -1 with the error set
+    int operator()(PyObject* item) const {
+        if (item == value) return 1;
+        if (Py_TYPE(item) == type) {
+            if (type == &PyUnicode_Type) {
+                return PyUnicode_GET_LENGTH(item) == PyUnicode_GET_LENGTH(value) &&
+                       PyUnicode_KIND(item) == PyUnicode_KIND(value) &&
+                       memcmp(PyUnicode_DATA(item), PyUnicode_DATA(value), 
+                              PyUnicode_GET_LENGTH(item) * PyUnicode_KIND(item)) == 0;
+            }
+            if (type == &PyFloat_Type) return PyFloat_AS_DOUBLE(item) == PyFloat_AS_DOUBLE(value);
+            if (type == &PyLong_Type && native_number) {
+                // Single-digit ints are read in place
+#if PY_VERSION_HEX >= 0x030C0000
+                if (PyUnstable_Long_IsCompact(reinterpret_cast<PyLongObject*>(item))) 
+                    return PyUnstable_Long_CompactValue(reinterpret_cast<PyLongObject*>(item)) == number;
+#else
+                Py_ssize_t digits = Py_SIZE(item);
+                if (digits >= -1 && digits <= 1) 
+                    return digits * static_cast<long long>(reinterpret_cast<PyLongObject*>(item)->ob_digit[0]) == number;
+#endif
+                int overflow = 0;
+                long long other = PyLong_AsLongLongAndOverflow(item, &overflow);
+                if (!overflow) return other == number;
+                return 0;
+            }
+            if (type == &PyBool_Type) return 0;
+        }
+        return PyObject_RichCompareBool(item, value, Py_EQ);
+    }
+};
+
+inline bool scannable(PyObject* sequence) {
+    return sequence && (PyList_Check(sequence) || PyTuple_Check(sequence));
+}
+
+// Item arrays are re-read on each step: a fallback call may run Python
+// code that resizes the list
+template<typename Visit>
+Py_ssize_t scan_items(PyObject* sequence, Visit&& visit) {
+    if (PyTuple_Check(sequence)) {
+        PyObject** items = reinterpret_cast<PyTupleObject*>(sequence)->ob_item;
+        Py_ssize_t size = PyTuple_GET_SIZE(sequence);
+        for (Py_ssize_t i = 0; i < size; ++i) {
+            int result = visit(items[i]);
+            if (result != 0) return result < 0 ? -1 : i;
+        }
+        return size;
+    }
+    
+    PyListObject* list = reinterpret_cast<PyListObject*>(sequence);
+    for (Py_ssize_t i = 0; i < Py_SIZE(list); ++i) {
+        int result = visit(list->ob_item[i]);
+        if (result != 0) return result < 0 ? -1 : i;
+    }
+    return Py_SIZE(list);
+}
+
+// Index of the first item whose truth is `wanted`, the size if none, -1 on error
+inline Py_ssize_t find_truth(PyObject* sequence, bool wanted) {
+    return scan_items(sequence, [wanted](PyObject* item) {
+        int truth = item_truth(item);
+        return truth < 0 ? -1 : (truth == static_cast<int>(wanted));
+    });
+}
+
+// list.index(value) semantics; -1 if missing (error cleared)
+inline Py_ssize_t find_item(PyObject* sequence, PyObject* value) {
+    ItemMatcher matches(value);
+    Py_ssize_t index = scan_items(sequence, matches);
+    if (index < 0) PyErr_Clear();
+    return index == PySequence_Fast_GET_SIZE(sequence) ? -1 : index;
+}
+
+inline Py_ssize_t count_items(PyObject* sequence, PyObject* value) {
+    ItemMatcher matches(value);
+    Py_ssize_t count = 0;
+    Py_ssize_t end = scan_items(sequence, [&](PyObject* item) {
+        int result = matches(item);
+        if (result > 0) ++count;
+        return result < 0 ? -1 : 0;
+    });
+    if (end < 0) {
+        PyErr_Clear();
+        return 0;
+    }
+    return count;
+}
+} // end namespace detail
+
+// ================== List Class ==================
+class List : public PyObj {
+public:
+    List() : PyObj(steal(PyList_New(0))) {}
+    explicit List(PyObject* o) : PyObj(o) {}
+    List(stolen_ref r) : PyObj(r) {}
+    List(borrowed_ref r) : PyObj(r) {}
+    
+    List(const std::initializer_list<PyObj>& elements)
+        : PyObj(steal(PyList_New(elements.size()))) {
+        if (!obj) return;
+        
+        size_t index = 0;
+        for (const auto& value : elements) {
+            Py_XINCREF(value.get_obj());
+            PyList_SetItem(obj, index++, value.get_obj());
+        }
+    }
+
+    // List manipulation methods
+    void append(const PyObj& value) { 
+        PyList_Append(obj, value.get_obj()); 
+    }
+    
+    void extend(const List& other) {
+        PyObject* result = detail::call_method(obj, "extend", other.get_obj());
+        Py_XDECREF(result);
+    }
+    
+    void insert(long index, const PyObj& value) {
+        PyList_Insert(obj, index, value.get_obj());
+    }
+    
+    void remove(const PyObj& value) {
+        PyObject* result = detail::call_method(obj, "remove", value.get_obj());
+        Py_XDECREF(result);
+    }
+    
+    PyObj pop(int index = -1) {
+        if (!obj) return PyObj();
+        
+        Py_ssize_t size = PyList_Size(obj);
+        if (index < 0) index += size;
+        if (index < 0 || index >= size) return PyObj();
+        
+        PyObj item(borrow(PyList_GetItem(obj, index)));
+        PySequence_DelItem(obj, index);
+        
+        return item;
+    }
+    
+    void clear() {
+        PyObject* result = detail::call_method(obj, "clear");
+        Py_XDECREF(result);
+    }
+    
+    long index(const PyObj& value) const {
+        if (detail::scannable(obj) && value.get_obj()) return detail::find_item(obj, value.get_obj());
+        
+        PyObject* result = detail::call_method(obj, "index", value.get_obj());
+        long index_value = result ? PyLong_AsLong(result) : -1;
+        Py_XDECREF(result);
+        
+        return index_value;
+    }
+    
+    long count(const PyObj& value) const {
+        if (detail::scannable(obj) && value.get_obj()) return detail::count_items(obj, value.get_obj());
+        
+        PyObject* result = detail::call_method(obj, "count", value.get_obj());
+        long count_value = result ? PyLong_AsLong(result) : 0;
+        Py_XDECREF(result);
+        
+        return count_value;
+    }
+    
+    void reverse() {
+        PyList_Reverse(obj);
+    }
+    
+    void sort() {
+        PyList_Sort(obj);
+    }
+    
+    // list.sort(key=key, reverse=reverse); a null or None key sorts by item
+    void sort(const PyObj& key, bool reverse = false) {
+        detail::sort_list(obj, key.get_obj(), reverse);
+    }
+    
+    // Sorts by native T keys extracted once per item (see detail::sort_by_key).
+    // Build with -DPYOBJ_PARALLEL_SORT to sort with std::execution policies
+    // (libstdc++ then needs TBB at link time). Returns false and leaves the
+    // list unchanged if a key cannot be extracted.
+    template<typename T, typename F>
+    bool sort_by(F&& extractor, bool reverse = false) {
+        return detail::sort_by_key<T>(obj, extractor, reverse);
+    }
+
+    // Length and contains
+    long len() const { return obj ? PyList_Size(obj) : 0; }
+
+    bool contains(const PyObj& value) const {
+        if (!obj) return false;
+        
+        int result = PySequence_Contains(obj, value.get_obj());
+        if (result == -1) { 
+            PyErr_Clear(); 
+            return false; 
+        }
+        
+        return result == 1;
+    }
+
+    // Indexing
+    PyObj operator[](long index) const {
+        if (!obj) return PyObj();
+        
+        Py_ssize_t size = PyList_Size(obj);
+        if (index < 0) index += size;
+        if (index < 0 || index >= size) return PyObj();
+        
+        return PyObj(borrow(PyList_GetItem(obj, index)));
+    }
+
+    bool set(long index, const PyObj& value) {
+        if (!obj) return false;
+        
+        Py_XINCREF(value.get_obj());
+        return PyList_SetItem(obj, index, value.get_obj()) == 0;
+    }
+
+    // List operations
+    List operator+(const List& other) const {
+        if (!obj || !other.get_obj()) return List();
+        
+        PyObject* result = PySequence_Concat(obj, other.get_obj());
+        return List(steal(result));
+    }
+
+    List& operator+=(const List& other) {
+        extend(other);
+        return *this;
+    }
+
+    List operator*(long n) const {
+        if (!obj) return List();
+        
+        PyObject* result = PySequence_Repeat(obj, n);
+        return List(steal(result));
+    }
+
+    List& operator*=(long n) {
+        PyObject* result = PySequence_Repeat(obj, n);
+        if (result) {
+            Py_XDECREF(obj);
+            obj = result;
+        }
+        return *this;
+    }
+
+    // Comparison operators
+    bool operator==(const List& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_EQ) == 1;
+    }
+    
+    bool operator!=(const List& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_NE) == 1;
+    }
+    
+    bool operator<(const List& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LT) == 1;
+    }
+    
+    bool operator<=(const List& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LE) == 1;
+    }
+    
+    bool operator>(const List& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GT) == 1;
+    }
+    
+    bool operator>=(const List& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GE) == 1;
+    }
+
+    // String representation
+    std::string str() const {
+        if (!obj) return "None";
+        
+        PyObject* string_obj = PyObject_Str(obj);
+        if (!string_obj) return "None";
+        
+        const char* c_str = PyUnicode_AsUTF8(string_obj);
+        std::string result = c_str ? c_str : "";
+        Py_XDECREF(string_obj);
+        
+        return result;
+    }
+
+    // Items are viewed in place as borrowed handles (const PyObj&); the
+    // list must not be resized while it is being iterated
+    using iterator = const PyObj*;
+    
+    iterator begin() const {
+        return obj && PyList_Check(obj) ? detail::as_handles(reinterpret_cast<PyListObject*>(obj)->ob_item) : nullptr;
+    }
+    iterator end() const { 
+        return obj && PyList_Check(obj) ? begin() + PyList_GET_SIZE(obj) : nullptr; 
+    }
+};
+
+// ================== Tuple Class ==================
+class Tuple : public PyObj {
+public:
+    Tuple() : PyObj(steal(PyTuple_New(0))) {}
+    explicit Tuple(PyObject* o) : PyObj(o) {}
+    Tuple(stolen_ref r) : PyObj(r) {}
+    Tuple(borrowed_ref r) : PyObj(r) {}
+    
+    Tuple(const std::initializer_list<PyObj>& elements) {
+        PyObject* tuple = PyTuple_New(elements.size());
+        if (!tuple) {
+            obj = nullptr;
+            return;
+        }
+        
+        size_t index = 0;
+        for (auto& value : elements) {
+            Py_XINCREF(value.get_obj());
+            PyTuple_SetItem(tuple, index++, value.get_obj());
+        }
+        obj = tuple;
+    }
+
+    // Basic operations
+    long len() const { return obj ? PyTuple_Size(obj) : 0; }
+
+    PyObj operator[](long index) const {
+        if (!obj) return PyObj();
+        
+        Py_ssize_t size = PyTuple_Size(obj);
+        if (index < 0) index += size;
+        if (index < 0 || index >= size) return PyObj();
+        
+        return PyObj(borrow(PyTuple_GetItem(obj, index)));
+    }
+
+    long index(const PyObj& value) const {
+        if (!obj) return -1;
+        if (detail::scannable(obj) && value.get_obj()) return detail::find_item(obj, value.get_obj());
+        
+        Py_ssize_t idx = PySequence_Index(obj, value.get_obj());
+        if (idx == -1 && PyErr_Occurred()) { 
+            PyErr_Clear(); 
+            return -1; 
+        }
+        
+        return idx;
+    }
+
+    long count(const PyObj& value) const {
+        if (!obj) return 0;
+        if (detail::scannable(obj) && value.get_obj()) return detail::count_items(obj, value.get_obj());
+        
+        Py_ssize_t count_value = PySequence_Count(obj, value.get_obj());
+        if (count_value == -1 && PyErr_Occurred()) { 
+            PyErr_Clear(); 
+            return 0; 
+        }
+        
+        return count_value;
+    }
+
+    bool contains(const PyObj& value) const {
+        if (!obj) return false;
+        
+        int result = PySequence_Contains(obj, value.get_obj());
+        if (result == -1) { 
+            PyErr_Clear(); 
+            return false; 
+        }
+        
+        return result == 1;
+    }
+
+    // Tuple operations
+    Tuple operator+(const Tuple& other) const {
+        if (!obj || !other.get_obj()) return Tuple();
+        
+        PyObject* result = PySequence_Concat(obj, other.get_obj());
+        return Tuple(steal(result));
+    }
+
+    Tuple operator*(long n) const {
+        if (!obj) return Tuple();
+        
+        PyObject* result = PySequence_Repeat(obj, n);
+        return Tuple(steal(result));
+    }
+
+    // Comparison operators
+    bool operator==(const Tuple& other) const {
+        if (!obj || !other.get_obj()) return false;
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_EQ) == 1;
+    }
+
+    bool operator!=(const Tuple& other) const {
+        if (!obj || !other.get_obj()) return true;
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_NE) == 1;
+    }
+
+    bool operator<(const Tuple& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LT) == 1;
+    }
+
+    bool operator<=(const Tuple& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_LE) == 1;
+    }
+
+    bool operator>(const Tuple& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GT) == 1;
+    }
+
+    bool operator>=(const Tuple& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_GE) == 1;
     }
 
     // Conversion
     List to_list() const {
         if (!obj) return List();
         
-        PyObject* list = PySequence_List(obj);
-        return List(list);
+        PyObject* list = PySequence_List(obj);
+        return List(steal(list));
+    }
+
+    // String representation
+    std::string str() const {
+        if (!obj) return "None";
+        
+        PyObject* string_obj = PyObject_Str(obj);
+        if (!string_obj) return "None";
+        
+        const char* c_str = PyUnicode_AsUTF8(string_obj);
+        std::string result = c_str ? c_str : "";
+        Py_XDECREF(string_obj);
+        
+        return result;
+    }
+
+    // Items are viewed in place as borrowed handles (const PyObj&)
+    using iterator = const PyObj*;
+    
+    iterator begin() const {
+        return obj && PyTuple_Check(obj) ? detail::as_handles(reinterpret_cast<PyTupleObject*>(obj)->ob_item) : nullptr;
+    }
+    iterator end() const { 
+        return obj && PyTuple_Check(obj) ? begin() + PyTuple_GET_SIZE(obj) : nullptr; 
+    }
+};
+
+// ================== Set Class ==================
+class Set : public PyObj {
+public:
+    Set() : PyObj(steal(PySet_New(nullptr))) {}
+    explicit Set(PyObject* o) : PyObj(o) {}
+    Set(stolen_ref r) : PyObj(r) {}
+    Set(borrowed_ref r) : PyObj(r) {}
+    
+    Set(const std::initializer_list<PyObj>& elements) 
+        : PyObj(steal(PySet_New(nullptr))) {
+        if (!obj) return;
+        
+        for (auto& value : elements)
+            PySet_Add(obj, value.get_obj());
+    }
+
+    // Set operations
+    void add(const PyObj& value) { 
+        PySet_Add(obj, value.get_obj()); 
+    }
+    
+    void clear() { 
+        PySet_Clear(obj); 
+    }
+    
+    PyObj pop() { 
+        return PyObj(steal(PySet_Pop(obj))); 
+    }
+
+    // Basic properties
+    long len() const { return obj ? PySet_Size(obj) : 0; }
+    bool empty() const { return len() == 0; }
+
+    bool contains(const PyObj& value) const {
+        return obj && PySet_Contains(obj, value.get_obj()) == 1;
+    }
+
+    // Comparison operators
+    bool operator==(const Set& other) const { 
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_EQ) == 1; 
+    }
+    
+    bool operator!=(const Set& other) const { 
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_NE) == 1; 
+    }
+    
+    bool operator<(const Set& other)  const { 
+        return len() < other.len() && issubset(other); 
+    }
+    
+    bool operator>(const Set& other)  const { 
+        return len() > other.len() && issuperset(other); 
+    }
+    
+    bool operator<=(const Set& other) const { 
+        return issubset(other); 
+    }
+    
+    bool operator>=(const Set& other) const { 
+        return issuperset(other); 
+    }
+
+    // Set theory operations
+    Set union_with(const Set& other) const {
+        PyObject* result = PyNumber_Or(obj, other.get_obj());
+        return Set(steal(result ? result : PySet_New(nullptr)));
+    }
+
+    Set intersection(const Set& other) const {
+        PyObject* result = PyNumber_And(obj, other.get_obj());
+        return Set(steal(result ? result : PySet_New(nullptr)));
+    }
+
+    Set difference(const Set& other) const {
+        PyObject* result = PyNumber_Subtract(obj, other.get_obj());
+        return Set(steal(result ? result : PySet_New(nullptr)));
+    }
+
+    Set symmetric_difference(const Set& other) const {
+        PyObject* result = PyNumber_Xor(obj, other.get_obj());
+        return Set(steal(result ? result : PySet_New(nullptr)));
+    }
+
+    // Compound assignment operators, run by the set slots directly. A
+    // frozenset cannot change and gets a new object as before.
+    Set& operator|=(const Set& other) {
+        return update_in_place(PyNumber_InPlaceOr, other);
+    }
+
+    // Drops the items missing from other without building a new set
+    Set& operator&=(const Set& other) {
+        if (!obj || !PySet_Check(obj) || !other.get_obj() || !PyAnySet_Check(other.get_obj()))
+            return update_in_place(PyNumber_InPlaceAnd, other);
+        if (obj == other.get_obj()) return *this;
+        
+        std::vector<PyObject*> missing;
+        for (const PyObj& item : *this) {
+            int found = PySet_Contains(other.get_obj(), item.get_obj());
+            if (found < 0) {
+                PyErr_Clear();
+                continue;
+            }
+            if (!found) {
+                Py_INCREF(item.get_obj());
+                missing.push_back(item.get_obj());
+            }
+        }
+        
+        for (PyObject* item : missing) {
+            if (PySet_Discard(obj, item) < 0) PyErr_Clear();
+            Py_DECREF(item);
+        }
+        return *this;
+    }
+    
+    Set& operator-=(const Set& other) {
+        return update_in_place(PyNumber_InPlaceSubtract, other);
+    }
+    
+    Set& operator^=(const Set& other) {
+        return update_in_place(PyNumber_InPlaceXor, other);
+    }
+
+    // Merges each set in turn with |=, which reuses the hashes already
+    // stored in its table instead of hashing every item again. The list
+    // holds handles, so building it costs one incref per set.
+    Set& update_many(std::initializer_list<Set> others) {
+        for (const Set& other : others) update_in_place(PyNumber_InPlaceOr, other);
+        return *this;
+    }
+    
+    Set& update_many(const std::vector<Set>& others) {
+        for (const Set& other : others) update_in_place(PyNumber_InPlaceOr, other);
+        return *this;
+    }
+
+    // Binary set operators
+    Set operator|(const Set& other) const { return union_with(other); }
+    Set operator&(const Set& other) const { return intersection(other); }
+    Set operator-(const Set& other) const { return difference(other); }
+    Set operator^(const Set& other) const { return symmetric_difference(other); }
+
+    // Set relations. Only the smaller side is walked, probing the larger
+    // one with PySet_Contains, and a size mismatch answers without a walk.
+    bool issubset(const Set& other) const {
+        return Set::includes(other.get_obj(), obj);
+    }
+
+    bool issuperset(const Set& other) const {
+        return Set::includes(obj, other.get_obj());
+    }
+
+    bool isdisjoint(const Set& other) const {
+        if (!obj || !other.get_obj() || !PyAnySet_Check(obj) || !PyAnySet_Check(other.get_obj())) return false;
+        
+        const Set& smaller = len() <= other.len() ? *this : other;
+        PyObject* larger = len() <= other.len() ? other.get_obj() : obj;
+        for (const PyObj& item : smaller) {
+            int found = PySet_Contains(larger, item.get_obj());
+            if (found != 0) {
+                if (found < 0) PyErr_Clear();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Walks the hash table directly and views each key in place; a slot is
+    // live when its key is set and its hash is not -1 (dummy). The set must
+    // not change while it is being iterated.
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = PyObj;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const PyObj*;
+        using reference = const PyObj&;
+        
+        iterator() = default;
+        iterator(PyObject* set, Py_ssize_t pos) : set(set), pos(pos) { skip(); }
+        
+        reference operator*() const { return *detail::as_handles(&table()[pos].key); }
+        pointer operator->() const { return detail::as_handles(&table()[pos].key); }
+        
+        iterator& operator++() {
+            ++pos;
+            skip();
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        
+        bool operator==(const iterator& other) const { return set == other.set && pos == other.pos; }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+    
+    private:
+        PyObject* set = nullptr;
+        Py_ssize_t pos = 0;
+        
+        setentry* table() const { return reinterpret_cast<PySetObject*>(set)->table; }
+        
+        void skip() {
+            if (!set) return;
+            
+            Py_ssize_t mask = reinterpret_cast<PySetObject*>(set)->mask;
+            while (pos <= mask && (!table()[pos].key || table()[pos].hash == -1)) ++pos;
+            if (pos > mask) {
+                set = nullptr;
+                pos = 0;
+            }
+        }
+    };
+    
+    iterator begin() const { return obj && PyAnySet_Check(obj) ? iterator(obj, 0) : iterator(); }
+    iterator end() const { return iterator(); }
+
+private:
+    // Whether every item of part is in whole
+    static bool includes(PyObject* whole, PyObject* part) {
+        if (!whole || !part || !PyAnySet_Check(whole) || !PyAnySet_Check(part)) return false;
+        if (PySet_GET_SIZE(part) > PySet_GET_SIZE(whole)) return false;
+        if (whole == part) return true;
+        
+        for (iterator it(part, 0); it != iterator(); ++it) {
+            int found = PySet_Contains(whole, it->get_obj());
+            if (found != 1) {
+                if (found < 0) PyErr_Clear();
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    Set& update_in_place(PyObject* (*operation)(PyObject*, PyObject*), const Set& other) {
+        if (!obj || !other.get_obj()) return *this;
+        
+        PyObject* result = operation(obj, other.get_obj());
+        if (!result) {
+            PyErr_Clear();
+            return *this;
+        }
+        
+        // Mutable sets hand back themselves; frozensets a new object
+        Py_DECREF(obj);
+        obj = result;
+        return *this;
+    }
+};
+
+// ================== Dict Keys ==================
+namespace detail {
+// Interned str for a C-string key, cached per thread by content so d["x"]
+// neither allocates nor rehashes. Borrowed reference.
+inline PyObject* key_string(const char* text) {
+    struct KeyCache {
+        int64_t interpreter = -1;
+        uint64_t generation = 0;
+        std::unordered_map<std::string, PyObject*> keys;
+    };
+    thread_local KeyCache cache;
+    constexpr size_t limit = 4096;
+    
+    int64_t id = interpreter_id();
+    uint64_t generation = interpreter_generation().load(std::memory_order_relaxed);
+    if (cache.interpreter != id || cache.generation != generation) {
+        // Entries of another (maybe finalized) interpreter are dropped unreleased
+        cache.keys.clear();
+        cache.interpreter = id;
+        cache.generation = generation;
+    }
+    
+    auto it = cache.keys.find(text);
+    if (it != cache.keys.end()) return it->second;
+    
+    if (cache.keys.size() >= limit) {
+        for (auto& entry : cache.keys) Py_DECREF(entry.second);
+        cache.keys.clear();
+    }
+    
+    PyObject* key = PyUnicode_InternFromString(text);
+    if (!key) return nullptr;
+    if (PyObject_Hash(key) == -1) {
+        Py_DECREF(key);
+        return nullptr;
+    }
+    
+    cache.keys.emplace(text, key);
+    return key;
+}
+
+// Strs behind py::Key. Every distinct key text gets a slot number, and each
+// interpreter owns one str per slot, released when that interpreter exits
+struct KeyTable {
+    std::mutex mutex;
+    std::unordered_map<std::string, uint32_t> slots;
+    std::unordered_map<int64_t, std::vector<PyObject*>> strs;
+    bool hooked = false;
+};
+
+inline KeyTable& key_table() {
+    static KeyTable table;
+    return table;
+}
+
+inline void drop_interpreter_keys() {
+    std::vector<PyObject*> strs;
+    {
+        KeyTable& table = key_table();
+        std::lock_guard<std::mutex> lock(table.mutex);
+        
+        auto it = table.strs.find(interpreter_id());
+        if (it == table.strs.end()) return;
+        
+        strs.swap(it->second);
+        table.strs.erase(it);
+    }
+    for (PyObject* str : strs) Py_XDECREF(str);
+}
+
+// Slots start at 1, 0 means not assigned yet
+inline uint32_t key_slot(const std::string& text) {
+    KeyTable& table = key_table();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    
+    auto it = table.slots.find(text);
+    if (it != table.slots.end()) return it->second;
+    
+    uint32_t slot = static_cast<uint32_t>(table.slots.size() + 1);
+    table.slots.emplace(text, slot);
+    return slot;
+}
+
+// The current interpreter's str for a slot, made on first use. Borrowed
+// reference owned by the table, nullptr with the Python error set.
+inline PyObject* key_str(uint32_t slot, const std::string& text) {
+    KeyTable& table = key_table();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    
+    std::vector<PyObject*>& strs = table.strs[interpreter_id()];
+    if (strs.size() <= slot) strs.resize(slot + 1, nullptr);
+    if (strs[slot]) return strs[slot];
+    
+    PyObject* str = PyUnicode_InternFromString(text.c_str());
+    if (str && PyObject_Hash(str) == -1) Py_CLEAR(str);
+    strs[slot] = str;
+    
+    if (str && !table.hooked) {
+        table.hooked = true;
+        on_interpreter_exit(drop_interpreter_keys);
+    }
+    return str;
+}
+
+// Per-thread copy of the current interpreter's slots, so a hit takes no lock
+struct KeyFront {
+    int64_t interpreter = -1;
+    uint64_t generation = 0;
+    std::vector<PyObject*> strs;
+};
+
+inline KeyFront& key_front() {
+    thread_local KeyFront front;
+    return front;
+}
+} // end namespace detail
+
+// A dict key made once and reused: an interned str with its hash already
+// computed, so lookups go straight to the hash table probe. Intended for
+// constant field names, e.g. static const py::Key id("id"). The Key itself
+// holds no Python object: each interpreter gets its own str, kept in a
+// shared per-interpreter table and looked up through a per-thread cache,
+// so one Key can be used from several threads and interpreters at once.
+class Key {
+public:
+    Key(const char* text) : text(text) {}
+    explicit Key(std::string_view text) : text(text) {}
+    explicit Key(const std::string& text) : text(text) {}
+    
+    Key(const Key& other) : text(other.text), slot(other.slot.load(std::memory_order_relaxed)) {}
+    Key& operator=(const Key& other) {
+        if (this != &other) {
+            text = other.text;
+            slot.store(other.slot.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+        return *this;
+    }
+    
+    const std::string& name() const { return text; }
+    
+    // Borrowed reference, nullptr with the Python error set on failure
+    PyObject* get() const {
+        // Racing threads compute the same slot, so a relaxed store is enough
+        uint32_t index = slot.load(std::memory_order_relaxed);
+        if (index == 0) {
+            index = detail::key_slot(text);
+            slot.store(index, std::memory_order_relaxed);
+        }
+        
+        detail::KeyFront& front = detail::key_front();
+        int64_t id = detail::interpreter_id();
+        uint64_t generation = detail::interpreter_generation().load(std::memory_order_relaxed);
+        if (front.interpreter != id || front.generation != generation) {
+            front.strs.clear();
+            front.interpreter = id;
+            front.generation = generation;
+        }
+        
+        if (index < front.strs.size() && front.strs[index]) return front.strs[index];
+        
+        PyObject* str = detail::key_str(index, text);
+        if (!str) return nullptr;
+        
+        if (front.strs.size() <= index) front.strs.resize(index + 1, nullptr);
+        front.strs[index] = str;
+        return str;
+    }
+    
+    Py_hash_t hash() const {
+        PyObject* key = get();
+        return key ? PyObject_Hash(key) : -1;
+    }
+
+private:
+    std::string text;
+    mutable std::atomic<uint32_t> slot{0};
+};
+
+// ================== Dict Class ==================
+class Dict : public PyObj {
+public:
+    Dict() : PyObj(steal(PyDict_New())) {}
+    explicit Dict(PyObject* o) : PyObj(o) {}
+    Dict(stolen_ref r) : PyObj(r) {}
+    Dict(borrowed_ref r) : PyObj(r) {}
+    
+    Dict(const std::initializer_list<std::pair<PyObj, PyObj>>& elements)
+        : PyObj(steal(PyDict_New())) {
+        if (!obj) return;
+        
+        for (auto& pair : elements)
+            PyDict_SetItem(obj, pair.first.get_obj(), pair.second.get_obj());
+    }
+
+    // Dictionary operations
+    void add(const PyObj& key, const PyObj& value) {
+        PyDict_SetItem(obj, key.get_obj(), value.get_obj());
+    }
+
+    PyObj get(const PyObj& key) const {
+        return PyObj(borrow(PyDict_GetItem(obj, key.get_obj())));
+    }
+
+    bool contains(const PyObj& key) const {
+        return PyDict_Contains(obj, key.get_obj()) == 1;
+    }
+
+    PyObj operator[](const PyObj& key) const {
+        return get(key);
+    }
+    
+    // Interned-key fast paths: string keys come ready-hashed from Key or
+    // the per-thread key cache instead of a fresh str per access
+    PyObj get(const Key& key) const { return lookup(key.get()); }
+    PyObj get(const char* key) const { return lookup(detail::key_string(key)); }
+    
+    bool contains(const Key& key) const { return lookup(key.get()).get_obj() != nullptr; }
+    bool contains(const char* key) const { return lookup(detail::key_string(key)).get_obj() != nullptr; }
+    
+    PyObj operator[](const Key& key) const { return get(key); }
+    PyObj operator[](const char* key) const { return get(key); }
+    
+    bool set(const Key& key, const PyObj& value) { return store(key.get(), value); }
+    bool set(const char* key, const PyObj& value) { return store(detail::key_string(key), value); }
+    
+    // Looks up several keys in one call; missing keys give empty handles
+    std::vector<PyObj> get_many(std::initializer_list<Key> keys) const {
+        std::vector<PyObj> values;
+        values.reserve(keys.size());
+        for (const Key& key : keys) values.push_back(get(key));
+        return values;
+    }
+    
+    template<typename... Keys>
+    std::array<PyObj, sizeof...(Keys)> get_many(const Keys&... keys) const {
+        return { get(keys)... };
+    }
+
+    // Dictionary setter helper class
+    class DictSetter {
+        PyObject* dict;
+        PyObj key;
+        
+    public:
+        DictSetter(PyObject* d, const PyObj& k) : dict(d), key(k) {}
+
+        void operator=(const PyObj& value) const {
+            if (!key.get_obj()) return;
+            PyDict_SetItem(dict, key.get_obj(), value.get_obj());
+        }
+
+        operator PyObj() const {
+            return PyObj(borrow(PyDict_GetItem(dict, key.get_obj())));
+        }
+    };
+
+    DictSetter operator[](const PyObj& key) {
+        return DictSetter(obj, key);
+    }
+    
+    DictSetter operator[](const Key& key) {
+        return DictSetter(obj, PyObj(borrow(key.get())));
+    }
+    
+    DictSetter operator[](const char* key) {
+        return DictSetter(obj, PyObj(borrow(detail::key_string(key))));
+    }
+
+    bool set(const PyObj& key, const PyObj& value) {
+        return PyDict_SetItem(obj, key.get_obj(), value.get_obj()) == 0;
+    }
+
+    // Dictionary properties
+    size_t len() const { return PyDict_Size(obj); }
+    bool empty() const { return PyDict_Size(obj) == 0; }
+    void clear() { PyDict_Clear(obj); }
+
+    PyObj pop(const PyObj& key) {
+        PyObject* value = PyDict_GetItem(obj, key.get_obj());
+        if (!value) return PyObj();
+        
+        PyObj result(borrow(value));
+        PyDict_DelItem(obj, key.get_obj());
+        
+        return result;
+    }
+
+    // Dictionary views
+    List keys() const { return List(steal(PyDict_Keys(obj))); }
+    List values() const { return List(steal(PyDict_Values(obj))); }
+    List items() const { return List(steal(PyDict_Items(obj))); }
+
+    void update(const Dict& other) { 
+        PyDict_Update(obj, other.get_obj()); 
+    }
+
+    // Comparison operators
+    bool operator==(const Dict& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_EQ) == 1;
+    }
+
+    bool operator!=(const Dict& other) const {
+        return PyObject_RichCompareBool(obj, other.get_obj(), Py_NE) == 1;
+    }
+
+    // Dictionary merging
+    Dict operator|(const Dict& other) const {
+        PyObject* merged = PyDict_Copy(obj);
+        if (!merged) return Dict();
+        
+        PyDict_Update(merged, other.get_obj());
+        return Dict(steal(merged));
+    }
+
+    Dict& operator|=(const Dict& other) {
+        PyDict_Update(obj, other.get_obj());
+        return *this;
+    }
+
+    Dict operator+(const Dict& other) const {
+        PyObject* merged = PyDict_Copy(obj);
+        if (!merged) return Dict();
+        
+        PyDict_Update(merged, other.get_obj());
+        return Dict(steal(merged));
+    }
+
+    Dict& operator+=(const Dict& other) {
+        PyDict_Update(obj, other.get_obj());
+        return *this;
+    }
+
+
+    // Key/value pair borrowed from the dict, valid while the entry stays in
+    // it. The item holds its own pointers, so it outlives the iterator.
+    // for (auto [key, value] : dict) binds both as const PyObj&.
+    class Item {
+    public:
+        Item(PyObject* key, PyObject* value) : k(key), v(value) {}
+        
+        const PyObj& key() const { return *detail::as_handles(&k); }
+        const PyObj& value() const { return *detail::as_handles(&v); }
+        
+        template<std::size_t I>
+        const PyObj& get() const {
+            static_assert(I < 2, "Dict::Item has a key and a value");
+            if constexpr (I == 0) return key();
+            else return value();
+        }
+    
+    private:
+        PyObject* k;
+        PyObject* v;
+    };
+    
+    // PyDict_Next without building an items() list or per-entry tuples.
+    // The dict must not change while it is being iterated.
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Item;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = Item;
+        
+        iterator() = default;
+        explicit iterator(PyObject* dict) : dict(dict) { ++*this; }
+        
+        Item operator*() const { return Item(key, value); }
+        
+        iterator& operator++() {
+            if (dict && !PyDict_Next(dict, &pos, &key, &value)) {
+                dict = nullptr;
+                pos = 0;
+            }
+            return *this;
+        }
+        iterator operator++(int) {
+            iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+        
+        bool operator==(const iterator& other) const { return dict == other.dict && pos == other.pos; }
+        bool operator!=(const iterator& other) const { return !(*this == other); }
+    
+    private:
+        PyObject* dict = nullptr;
+        Py_ssize_t pos = 0;
+        PyObject* key = nullptr;
+        PyObject* value = nullptr;
+    };
+    
+    iterator begin() const { return obj && PyDict_Check(obj) ? iterator(obj) : iterator(); }
+    iterator end() const { return iterator(); }
+private:
+    PyObj lookup(PyObject* key) const {
+        if (!obj || !key) {
+            PyErr_Clear();
+            return PyObj();
+        }
+        
+        PyObject* value = PyDict_GetItemWithError(obj, key);
+        if (!value) PyErr_Clear();
+        return PyObj(borrow(value));
+    }
+    
+    bool store(PyObject* key, const PyObj& value) {
+        if (!obj || !key || PyDict_SetItem(obj, key, value.get_obj()) < 0) {
+            PyErr_Clear();
+            return false;
+        }
+        return true;
+    }
+};
+
+static_assert(sizeof(PyObj) == sizeof(PyObject*) && sizeof(Str) == sizeof(PyObject*) && 
+              sizeof(List) == sizeof(PyObject*) && sizeof(Tuple) == sizeof(PyObject*) &&
+              sizeof(Set) == sizeof(PyObject*) && sizeof(Dict) == sizeof(PyObject*), 
+              "handles must stay a single pointer");
+
+// ================== Bytes Class ==================
+class Bytes : public PyObj {
+public:
+    Bytes() : PyObj(steal(PyBytes_FromStringAndSize(nullptr, 0))) {}
+    explicit Bytes(PyObject* o) : PyObj(o) {}
+    Bytes(stolen_ref r) : PyObj(r) {}
+    Bytes(borrowed_ref r) : PyObj(r) {}
+    Bytes(std::string_view data) 
+        : PyObj(steal(PyBytes_FromStringAndSize(data.data(), data.size()))) {}
+    Bytes(const void* data, size_t size) 
+        : PyObj(steal(PyBytes_FromStringAndSize(static_cast<const char*>(data), size))) {}
+
+    long len() const { return obj && PyBytes_Check(obj) ? PyBytes_GET_SIZE(obj) : 0; }
+
+    // Zero-copy view of the contents, valid while this Bytes is alive
+    std::string_view view() const {
+        if (!obj || !PyBytes_Check(obj)) return {};
+        return { PyBytes_AS_STRING(obj), static_cast<size_t>(PyBytes_GET_SIZE(obj)) };
+    }
+
+    bool operator==(const Bytes& other) const { return view() == other.view(); }
+    bool operator!=(const Bytes& other) const { return view() != other.view(); }
+};
+
+// ================== Buffer Protocol ==================
+namespace detail {
+// struct module format character for T, nullptr when T has none
+template<typename T>
+constexpr const char* buffer_format() {
+    using U = std::remove_cv_t<T>;
+    if constexpr (std::is_same_v<U, bool>) return "?";
+    else if constexpr (std::is_same_v<U, float>) return "f";
+    else if constexpr (std::is_same_v<U, double>) return "d";
+    else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+        if constexpr (sizeof(U) == 1) return "b";
+        else if constexpr (sizeof(U) == 2) return "h";
+        else if constexpr (sizeof(U) == 4) return "i";
+        else if constexpr (sizeof(U) == 8) return "q";
+        else return nullptr;
+    }
+    else if constexpr (std::is_integral_v<U>) {
+        if constexpr (sizeof(U) == 1) return "B";
+        else if constexpr (sizeof(U) == 2) return "H";
+        else if constexpr (sizeof(U) == 4) return "I";
+        else if constexpr (sizeof(U) == 8) return "Q";
+        else return nullptr;
+    }
+    else return nullptr;
+}
+
+// Whether items of a buffer with this format and item size can be read as T.
+// Sizes are compared rather than letters, so numpy's 'l' matches int64_t.
+template<typename T>
+inline bool buffer_matches(const char* format, Py_ssize_t itemsize) {
+    using U = std::remove_cv_t<T>;
+    if (itemsize != static_cast<Py_ssize_t>(sizeof(U))) return false;
+    if (!format) format = "B";
+    
+    if (*format == '@' || *format == '=') ++format;
+#if PY_LITTLE_ENDIAN
+    else if (*format == '<') ++format;
+#else
+    else if (*format == '>' || *format == '!') ++format;
+#endif
+    if (!format[0] || format[1]) return false;
+    
+    char code = format[0];
+    if constexpr (std::is_same_v<U, bool>) return code == '?';
+    else if constexpr (std::is_floating_point_v<U>) return strchr("efd", code) != nullptr;
+    else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) return strchr("bhilqn", code) != nullptr;
+    else if constexpr (std::is_integral_v<U>) return strchr("BHILQNc", code) != nullptr;
+    else return true;
+}
+} // end namespace detail
+
+// Typed, contiguous view of any object exporting the buffer protocol (bytes,
+// bytearray, array.array, numpy arrays, memoryview). No data is copied, the
+// exporter stays locked until the Buffer is destroyed.
+template<typename T>
+class Buffer {
+    Py_buffer view;
+    bool acquired = false;
+
+public:
+    Buffer() { memset(&view, 0, sizeof(view)); }
+
+    explicit Buffer(const PyObj& source) {
+        memset(&view, 0, sizeof(view));
+        if (!source.get_obj()) return;
+        
+        int flags = PyBUF_C_CONTIGUOUS | PyBUF_FORMAT;
+        if constexpr (!std::is_const_v<T>) flags |= PyBUF_WRITABLE;
+        
+        if (PyObject_GetBuffer(source.get_obj(), &view, flags) != 0) {
+            PyErr_Clear();
+            return;
+        }
+        
+        if (!detail::buffer_matches<T>(view.format, view.itemsize)) {
+            PyBuffer_Release(&view);
+            return;
+        }
+        acquired = true;
+    }
+
+    Buffer(Buffer&& other) noexcept : view(other.view), acquired(other.acquired) {
+        other.acquired = false;
+    }
+
+    Buffer& operator=(Buffer&& other) noexcept {
+        if (this != &other) {
+            if (acquired) PyBuffer_Release(&view);
+            view = other.view;
+            acquired = other.acquired;
+            other.acquired = false;
+        }
+        return *this;
+    }
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    ~Buffer() { 
+        if (acquired) PyBuffer_Release(&view); 
+    }
+
+    // False when the object has no buffer or its items are not T
+    bool valid() const { return acquired; }
+    explicit operator bool() const { return acquired; }
+
+    T* data() const { return acquired ? static_cast<T*>(view.buf) : nullptr; }
+    size_t size() const { return acquired ? static_cast<size_t>(view.len / view.itemsize) : 0; }
+    T* begin() const { return data(); }
+    T* end() const { return data() + size(); }
+    T& operator[](size_t index) const { return data()[index]; }
+
+#if __cplusplus >= 202002L
+    std::span<T> span() const { return { data(), size() }; }
+#endif
+};
+
+// ================== MemoryView Class ==================
+class MemoryView : public PyObj {
+public:
+    MemoryView() : PyObj() {}
+    explicit MemoryView(PyObject* o) : PyObj(o) {}
+    MemoryView(stolen_ref r) : PyObj(r) {}
+    MemoryView(borrowed_ref r) : PyObj(r) {}
+    
+    // memoryview(source) over any object exporting a buffer
+    explicit MemoryView(const PyObj& source) : PyObj() {
+        if (!source.get_obj()) return;
+        
+        obj = PyMemoryView_FromObject(source.get_obj());
+        if (!obj) PyErr_Clear();
+    }
+
+    // Exports C++ memory without copying. Python sees typed items (a
+    // memoryview of format 'd' for double) that are read-only for const T.
+    // The memory must outlive the view and every object made from it.
+    template<typename T>
+    MemoryView(T* data, size_t size) : PyObj() {
+        static_assert(detail::buffer_format<T>() != nullptr, "MemoryView: no buffer format for this type");
+        
+        Py_ssize_t shape = static_cast<Py_ssize_t>(size);
+        Py_ssize_t stride = sizeof(T);
+        
+        Py_buffer info;
+        memset(&info, 0, sizeof(info));
+        info.buf = const_cast<std::remove_cv_t<T>*>(data);
+        info.len = shape * stride;
+        info.itemsize = stride;
+        info.readonly = std::is_const_v<T> ? 1 : 0;
+        info.ndim = 1;
+        info.format = const_cast<char*>(detail::buffer_format<T>());
+        info.shape = &shape;
+        info.strides = &stride;
+        
+        // shape and strides are copied into the memoryview
+        obj = PyMemoryView_FromBuffer(&info);
+        if (!obj) PyErr_Clear();
+    }
+
+    template<typename T>
+    MemoryView(std::vector<T>& data) : MemoryView(data.data(), data.size()) {}
+
+    template<typename T>
+    MemoryView(const std::vector<T>& data) : MemoryView(data.data(), data.size()) {}
+
+#if __cplusplus >= 202002L
+    template<typename T, size_t Extent>
+    MemoryView(std::span<T, Extent> data) : MemoryView(data.data(), data.size()) {}
+#endif
+
+    long len() const { return obj ? static_cast<long>(PyObject_Length(obj)) : 0; }
+    bool readonly() const { return obj && PyMemoryView_Check(obj) && PyMemoryView_GET_BUFFER(obj)->readonly; }
+
+    Bytes tobytes() const {
+        if (!obj) return Bytes();
+        return Bytes(steal(PyBytes_FromObject(obj)));
+    }
+};
+
+// ================== Native Conversions ==================
+namespace detail {
+// Converter<T>::from() reads a borrowed object into T (false with the
+// Python error set if it cannot), Converter<T>::to() returns a new reference
+template<typename T, typename Enable>
+struct Converter;
+
+template<>
+struct Converter<bool> {
+    static bool from(PyObject* o, bool& out) {
+        if (o == Py_True) { out = true; return true; }
+        if (o == Py_False) { out = false; return true; }
+        
+        int truth = PyObject_IsTrue(o);
+        if (truth < 0) return false;
+        out = truth == 1;
+        return true;
+    }
+    static PyObject* to(bool value) { return PyBool_FromLong(value); }
+};
+
+template<typename T>
+struct Converter<T, std::enable_if_t<std::is_integral_v<T> && std::is_signed_v<T>>> {
+    static bool from(PyObject* o, T& out) {
+        long long value = PyLong_AsLongLong(o);
+        if (value == -1 && PyErr_Occurred()) return false;
+        if (value < std::numeric_limits<T>::min() || value > std::numeric_limits<T>::max()) {
+            PyErr_SetString(PyExc_OverflowError, "int too large for the C++ type");
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    }
+    static PyObject* to(T value) { return PyLong_FromLongLong(value); }
+};
+
+template<typename T>
+struct Converter<T, std::enable_if_t<std::is_integral_v<T> && std::is_unsigned_v<T> && !std::is_same_v<T, bool>>> {
+    static bool from(PyObject* o, T& out) {
+        unsigned long long value = PyLong_AsUnsignedLongLong(o);
+        if (value == static_cast<unsigned long long>(-1) && PyErr_Occurred()) return false;
+        if (value > std::numeric_limits<T>::max()) {
+            PyErr_SetString(PyExc_OverflowError, "int too large for the C++ type");
+            return false;
+        }
+        out = static_cast<T>(value);
+        return true;
+    }
+    static PyObject* to(T value) { return PyLong_FromUnsignedLongLong(value); }
+};
+
+template<typename T>
+struct Converter<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static bool from(PyObject* o, T& out) {
+        if (PyFloat_CheckExact(o)) {
+            out = static_cast<T>(PyFloat_AS_DOUBLE(o));
+            return true;
+        }
+        
+        double value = PyFloat_AsDouble(o);
+        if (value == -1.0 && PyErr_Occurred()) return false;
+        out = static_cast<T>(value);
+        return true;
+    }
+    static PyObject* to(T value) { return PyFloat_FromDouble(value); }
+};
+
+template<>
+struct Converter<std::string> {
+    static bool from(PyObject* o, std::string& out) {
+        if (PyUnicode_Check(o)) {
+            std::string_view text = unicode_view(o);
+            if (!text.data() && PyUnicode_GET_LENGTH(o) != 0) return false;
+            out.assign(text.data(), text.size());
+            return true;
+        }
+        if (PyBytes_Check(o)) {
+            out.assign(PyBytes_AS_STRING(o), PyBytes_GET_SIZE(o));
+            return true;
+        }
+        PyErr_SetString(PyExc_TypeError, "expected str or bytes");
+        return false;
+    }
+    static PyObject* to(const std::string& value) { 
+        return PyUnicode_FromStringAndSize(value.data(), value.size()); 
+    }
+};
+
+// PyObj and the typed wrappers are taken by reference
+template<typename T>
+struct Converter<T, std::enable_if_t<std::is_base_of_v<PyObj, T>>> {
+    static bool from(PyObject* o, T& out) {
+        out = T(borrow(o));
+        return true;
+    }
+    static PyObject* to(const T& value) {
+        PyObject* o = value.get_obj() ? value.get_obj() : Py_None;
+        Py_INCREF(o);
+        return o;
+    }
+};
+
+// Numeric items held in a matching buffer (array.array, numpy) are copied
+// in one go instead of being unboxed one by one
+template<typename T>
+inline bool read_buffer(PyObject* o, std::vector<T>& out) {
+    if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+        if (PyList_Check(o) || PyTuple_Check(o) || !PyObject_CheckBuffer(o)) return false;
+        
+        Buffer<const T> buffer{PyObj(o)};
+        if (!buffer) return false;
+        
+        out.assign(buffer.begin(), buffer.end());
+        return true;
+    } else {
+        return false;
+    }
+}
+} // end namespace detail
+
+// Converts a list, tuple, buffer or other iterable into a std::vector<T>.
+// An item that does not convert leaves the result empty.
+template<typename T>
+std::vector<T> to_vector(const PyObj& sequence) {
+    detail::ApiProbe<Api::ToVector> probe;
+    std::vector<T> output;
+    PyObject* source = sequence.get_obj();
+    if (!source) return output;
+    
+    if (detail::read_buffer(source, output)) return output;
+    
+    PyObject* fast = PySequence_Fast(source, "to_vector: expected a sequence");
+    if (!fast) {
+        PyErr_Clear();
+        return output;
+    }
+    
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(fast);
+    PyObject** items = PySequence_Fast_ITEMS(fast);
+    output.resize(size);
+    
+    for (Py_ssize_t i = 0; i < size; ++i) {
+        if (!detail::Converter<T>::from(items[i], output[i])) {
+            PyErr_Clear();
+            output.clear();
+            break;
+        }
+    }
+    
+    Py_DECREF(fast);
+    return output;
+}
+
+template<typename T>
+List from_vector(const std::vector<T>& values) {
+    detail::ApiProbe<Api::FromVector> probe;
+    PyObject* list = PyList_New(values.size());
+    if (!list) {
+        PyErr_Clear();
+        return List();
+    }
+    
+    for (size_t i = 0; i < values.size(); ++i) {
+        PyObject* item = detail::Converter<T>::to(values[i]);
+        if (!item) {
+            PyErr_Clear();
+            Py_DECREF(list);
+            return List();
+        }
+        PyList_SET_ITEM(list, i, item);
+    }
+    
+    return List(steal(list));
+}
+
+namespace detail {
+template<typename Map>
+Map to_map(const PyObj& dict) {
+    ApiProbe<Api::ToMap> probe;
+    Map output;
+    PyObject* source = dict.get_obj();
+    if (!source || !PyDict_Check(source)) return output;
+    
+    Py_ssize_t pos = 0;
+    PyObject *key, *value;
+    while (PyDict_Next(source, &pos, &key, &value)) {
+        typename Map::key_type native_key;
+        typename Map::mapped_type native_value;
+        
+        if (!Converter<typename Map::key_type>::from(key, native_key) ||
+            !Converter<typename Map::mapped_type>::from(value, native_value)) {
+            PyErr_Clear();
+            output.clear();
+            break;
+        }
+        output.emplace(std::move(native_key), std::move(native_value));
+    }
+    return output;
+}
+} // end namespace detail
+
+template<typename K, typename V>
+std::map<K, V> to_map(const PyObj& dict) {
+    return detail::to_map<std::map<K, V>>(dict);
+}
+
+template<typename K, typename V>
+std::unordered_map<K, V> to_unordered_map(const PyObj& dict) {
+    return detail::to_map<std::unordered_map<K, V>>(dict);
+}
+
+// Works for std::map, std::unordered_map and anything iterating as pairs
+template<typename Map>
+Dict from_map(const Map& values) {
+    detail::ApiProbe<Api::FromMap> probe;
+    Dict output;
+    for (const auto& entry : values) {
+        PyObject* key = detail::Converter<std::decay_t<decltype(entry.first)>>::to(entry.first);
+        PyObject* value = detail::Converter<std::decay_t<decltype(entry.second)>>::to(entry.second);
+        
+        bool stored = key && value && PyDict_SetItem(output.get_obj(), key, value) == 0;
+        Py_XDECREF(key);
+        Py_XDECREF(value);
+        
+        if (!stored) {
+            PyErr_Clear();
+            return Dict();
+        }
+    }
+    return output;
+}
+
+// ================== Function Class ==================
+class Function : public PyObj {
+public:
+    Function() : PyObj() {}
+    Function(PyObject* o) : PyObj(o) {}
+    Function(stolen_ref r) : PyObj(r) {}
+    Function(borrowed_ref r) : PyObj(r) {}
+    Function(const PyObj& o) : PyObj(o) {}
+
+    // ===== Universal calling method =====
+    PyObj call(const std::vector<PyObj>& args = {}) const {
+        return call_vector(args, nullptr);
+    }
+
+    PyObj call(const std::vector<PyObj>& args, const Dict& kwargs) const {
+        return call_vector(args, kwargs.get_obj());
+    }
+
+    // ===== Universal Call via () =====
+    template<typename... Args>
+    PyObj operator()(Args&&... args) const {
+        // If the last argument is Dict, consider it kwargs
+        if constexpr (sizeof...(args) > 0) {
+            using Last = std::tuple_element_t<sizeof...(args) - 1, std::tuple<std::decay_t<Args>...>>;
+            if constexpr (std::is_same_v<Last, Dict>) {
+                return call_with_kwargs(
+                    std::forward_as_tuple(std::forward<Args>(args)...), 
+                    std::make_index_sequence<sizeof...(args) - 1>{}
+                );
+            }
+        }
+
+        return vectorcall(nullptr, std::forward<Args>(args)...);
+    }
+
+    // ===== Call from any thread =====
+    // Does not need the GIL: takes it, converts the arguments, calls and
+    // hands the result to on_result before letting the GIL go again.
+    template<typename Callback, typename... Args>
+    void call_nogil_wrapped(Callback&& on_result, Args&&... args) const {
+        gil_acquire gil;
+        PyObj result = (*this)(std::forward<Args>(args)...);
+        on_result(result);
+    }
+
+    // ===== Batch calls =====
+    // One call per row under a single GIL hold, all rows sharing one
+    // argument array. Results line up with the rows; a failed call is
+    // reported and leaves None in its slot.
+    template<typename... Args>
+    List call_batch(const std::vector<std::tuple<Args...>>& rows) const {
+        gil_acquire gil;
+
+        List output(steal(PyList_New(rows.size())));
+        if (!output.get_obj()) {
+            detail::report_error();
+            return List();
+        }
+
+        batch(rows.data(), rows.data() + rows.size(), [&](size_t i, PyObject* result) {
+            if (!result) {
+                result = Py_None;
+                Py_INCREF(result);
+            }
+            PyList_SET_ITEM(output.get_obj(), i, result);
+            return true;
+        });
+        return output;
+    }
+
+    // Converts each result to T. False when any call or conversion failed,
+    // the slot keeping T{}.
+    template<typename T, typename... Args>
+    bool call_batch(const std::vector<std::tuple<Args...>>& rows, std::vector<T>& out) const {
+        return call_batch(rows.data(), rows.data() + rows.size(), out);
+    }
+
+    template<typename T, typename... Args>
+    bool call_batch(const std::tuple<Args...>* first, const std::tuple<Args...>* last, std::vector<T>& out) const {
+        gil_acquire gil;
+
+        out.assign(last - first, T{});
+        return batch(first, last, [&](size_t i, PyObject* result) {
+            if (!result) return false;
+
+            T value{};
+            bool converted = detail::Converter<T>::from(result, value);
+            Py_DECREF(result);
+            if (!converted) {
+                detail::report_error();
+                return false;
+            }
+            out[i] = std::move(value);
+            return true;
+        });
+    }
+
+    // Rows already in Python: a tuple or list row is spread into
+    // positional arguments, anything else is passed as the only one.
+    // Tuple rows are handed to the call as they are, without copying.
+    List call_batch(const List& rows) const {
+        gil_acquire gil;
+        detail::ApiProbe<Api::FunctionBatch> probe;
+
+        PyObject* fast = rows.get_obj() ? PySequence_Fast(rows.get_obj(), "call_batch: expected a sequence") : nullptr;
+        if (!fast) {
+            detail::report_error();
+            return List();
+        }
+        PyObj sequence(steal(fast));
+        if (!callable()) return List();
+
+        Py_ssize_t size = PySequence_Fast_GET_SIZE(fast);
+        List output(steal(PyList_New(size)));
+        if (!output.get_obj()) {
+            detail::report_error();
+            return List();
+        }
+
+        std::vector<PyObject*> stack;
+        for (Py_ssize_t i = 0; i < size; ++i) {
+            // The callable may shrink the rows under us, so re-read each round
+            PyObject* result = nullptr;
+            if (i < PySequence_Fast_GET_SIZE(fast)) {
+                PyObject* row = PySequence_Fast_ITEMS(fast)[i];
+                Py_INCREF(row);
+
+                if (PyTuple_CheckExact(row)) {
+                    result = PyObject_Vectorcall(obj, &PyTuple_GET_ITEM(row, 0), PyTuple_GET_SIZE(row), nullptr);
+                } else {
+                    // A list row can change size during the call, so its items are held
+                    bool spread = PyList_CheckExact(row);
+                    size_t count = spread ? PyList_GET_SIZE(row) : 1;
+                    stack.resize(std::max(stack.size(), count + 1));
+                    for (size_t j = 0; j < count; ++j) {
+                        stack[j + 1] = spread ? PyList_GET_ITEM(row, j) : row;
+                        Py_INCREF(stack[j + 1]);
+                    }
+
+                    result = PyObject_Vectorcall(obj, stack.data() + 1, count | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr);
+                    for (size_t j = 0; j < count; ++j) Py_DECREF(stack[j + 1]);
+                }
+                Py_DECREF(row);
+            }
+
+            if (!result) {
+                detail::report_error();
+                result = Py_None;
+                Py_INCREF(result);
+            }
+            PyList_SET_ITEM(output.get_obj(), i, result);
+        }
+
+        return output;
+    }
+
+    private:
+    bool callable() const {
+        if (obj && PyCallable_Check(obj)) return true;
+        detail::report_error(PyExc_TypeError, "object is not callable");
+        return false;
+    }
+
+    template<typename... Args, std::size_t... I>
+    static void fill(PyObject** arguments, const std::tuple<Args...>& row, std::index_sequence<I...>) {
+        ((arguments[I] = PyObj(std::get<I>(row)).release()), ...);
+    }
+
+    // Calls once per row, the converted arguments going into the same stack
+    // array each time. sink(index, result) takes the new reference (nullptr
+    // after a reported failure) and returns false when the row failed.
+    template<typename Sink, typename... Args>
+    bool batch(const std::tuple<Args...>* first, const std::tuple<Args...>* last, Sink&& sink) const {
+        detail::ApiProbe<Api::FunctionBatch> probe;
+        if (!callable()) return false;
+
+        constexpr size_t count = sizeof...(Args);
+        PyObject* stack[count + 1] = {};
+
+        bool succeeded = true;
+        for (const std::tuple<Args...>* row = first; row != last; ++row) {
+            fill(stack + 1, *row, std::index_sequence_for<Args...>{});
+
+            bool converted = true;
+            for (size_t j = 1; j <= count; ++j) converted = converted && stack[j];
+
+            PyObject* result = converted
+                ? PyObject_Vectorcall(obj, stack + 1, count | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr)
+                : nullptr;
+            for (size_t j = 1; j <= count; ++j) Py_XDECREF(stack[j]);
+
+            if (!result) {
+                if (!converted && !PyErr_Occurred())
+                    PyErr_SetString(PyExc_TypeError, "call_batch: argument does not convert to Python");
+                detail::report_error();
+            }
+            succeeded = sink(static_cast<size_t>(row - first), result) && succeeded;
+        }
+        return succeeded;
+    }
+
+    // Arguments are borrowed from the vector, up to 8 of them without
+    // touching the heap
+    PyObj call_vector(const std::vector<PyObj>& args, PyObject* kwargs) const {
+        detail::ApiProbe<Api::FunctionCall> probe;
+        if (!obj || !PyCallable_Check(obj)) {
+            detail::report_error(PyExc_TypeError, "object is not callable");
+            return PyObj();
+        }
+
+        PyObject* small[9];
+        std::vector<PyObject*> large;
+        PyObject** stack = small;
+        if (args.size() + 1 > 9) {
+            large.resize(args.size() + 1);
+            stack = large.data();
+        }
+        
+        for (size_t i = 0; i < args.size(); i++) stack[i + 1] = args[i].get_obj();
+
+        PyObject* result = PyObject_VectorcallDict(
+            obj, stack + 1, args.size() | PY_VECTORCALL_ARGUMENTS_OFFSET, kwargs
+        );
+
+        if (!result) {
+            detail::report_error();
+            return PyObj();
+        }
+
+        return PyObj(steal(result));
+    }
+
+    // Sized at compile time, the arguments live in a stack array
+    template<typename... Args>
+    PyObj vectorcall(PyObject* kwargs, Args&&... args) const {
+        detail::ApiProbe<Api::FunctionCall> probe;
+        if (!obj || !PyCallable_Check(obj)) {
+            detail::report_error(PyExc_TypeError, "object is not callable");
+            return PyObj();
+        }
+
+        constexpr size_t count = sizeof...(Args);
+        PyObject* stack[count + 1] = { nullptr, PyObj(std::forward<Args>(args)).release()... };
+        
+        bool converted = true;
+        for (size_t i = 1; i <= count; ++i) converted = converted && stack[i];
+
+        PyObject* result = converted
+            ? PyObject_VectorcallDict(obj, stack + 1, count | PY_VECTORCALL_ARGUMENTS_OFFSET, kwargs)
+            : nullptr;
+            
+        for (size_t i = 1; i <= count; ++i) Py_XDECREF(stack[i]);
+
+        if (!result) {
+            detail::report_error();
+            return PyObj();
+        }
+
+        return PyObj(steal(result));
+    }
+
+    template<typename Tuple, std::size_t... I>
+    PyObj call_with_kwargs(Tuple&& t, std::index_sequence<I...>) const {
+        const Dict& kwargs = std::get<sizeof...(I)>(t);
+        return vectorcall(kwargs.get_obj(), std::get<I>(std::forward<Tuple>(t))...);
+    }
+};
+
+// ================== Bound Method Handle ==================
+// Holds obj.name looked up once; calls go straight to the bound method
+// through vectorcall: auto split = line.method("split"); split(",");
+class Method : public Function {
+public:
+    Method() : Function() {}
+    Method(stolen_ref r) : Function(r) {}
+    Method(borrowed_ref r) : Function(r) {}
+    
+    Method(const PyObj& self, const std::string& name) : Function() {
+        if (!self.get_obj()) return;
+        
+        obj = PyObject_GetAttrString(self.get_obj(), name.c_str());
+        if (!obj) PyErr_Clear();
+    }
+};
+
+inline Method PyObj::method(const std::string& name) const {
+    return Method(*this, name);
+}
+
+// ================== Modules ==================
+namespace detail {
+// Modules from import() and attributes from Module::attr(), held per
+// interpreter until it exits. Strong references.
+struct ModuleCache {
+    std::mutex mutex;
+    std::unordered_map<int64_t, std::unordered_map<std::string, PyObject*>> handles;
+    bool hooked = false;
+};
+
+inline ModuleCache& module_cache() {
+    static ModuleCache cache;
+    return cache;
+}
+
+inline void drop_interpreter_modules() {
+    std::unordered_map<std::string, PyObject*> handles;
+    {
+        ModuleCache& cache = module_cache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        
+        auto it = cache.handles.find(interpreter_id());
+        if (it == cache.handles.end()) return;
+        
+        handles.swap(it->second);
+        cache.handles.erase(it);
+    }
+    for (auto& entry : handles) Py_DECREF(entry.second);
+}
+
+// Looks key up in a per-thread front cache, then the shared one, and only
+// calls load() (new reference or nullptr with the error set) on a miss.
+// Borrowed reference.
+template<typename Load>
+inline PyObject* cached_handle(const std::string& key, Load load) {
+    struct FrontCache {
+        int64_t interpreter = -1;
+        uint64_t generation = 0;
+        std::unordered_map<std::string, PyObject*> handles;
+    };
+    thread_local FrontCache front;
+    
+    int64_t id = interpreter_id();
+    uint64_t generation = interpreter_generation().load(std::memory_order_relaxed);
+    if (front.interpreter != id || front.generation != generation) {
+        front.handles.clear();
+        front.interpreter = id;
+        front.generation = generation;
+    }
+    
+    auto hit = front.handles.find(key);
+    if (hit != front.handles.end()) return hit->second;
+    
+    ModuleCache& cache = module_cache();
+    PyObject* handle = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto& handles = cache.handles[id];
+        auto found = handles.find(key);
+        if (found != handles.end()) handle = found->second;
+    }
+    
+    if (!handle) {
+        // Loaded without the lock: an import runs Python code that may import too
+        PyObject* loaded = load();
+        if (!loaded) return nullptr;
+        
+        PyObject* duplicate = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            auto slot = cache.handles[id].emplace(key, loaded);
+            if (!slot.second) duplicate = loaded;
+            handle = slot.first->second;
+            
+            if (!cache.hooked) {
+                cache.hooked = true;
+                on_interpreter_exit(drop_interpreter_modules);
+            }
+        }
+        Py_XDECREF(duplicate);
+    }
+    
+    front.handles.emplace(key, handle);
+    return handle;
+}
+} // end namespace detail
+
+// A module handle whose attribute lookups are cached. Attributes are
+// resolved once per interpreter, so later rebinding (or a reload) of a
+// module global is not seen through attr(). The cache is keyed by module
+// object, which it keeps alive so the address is never reused.
+class Module : public PyObj {
+public:
+    Module() : PyObj() {}
+    explicit Module(PyObject* o) : PyObj(o) {}
+    Module(stolen_ref r) : PyObj(r) {}
+    Module(borrowed_ref r) : PyObj(r) {}
+    
+    std::string name() const {
+        if (!obj) return std::string();
+        const char* text = PyModule_GetName(obj);
+        if (!text) {
+            PyErr_Clear();
+            return std::string();
+        }
+        return text;
+    }
+    
+    PyObj attr(const std::string& attr_name) const {
+        if (!obj) return PyObj();
+        
+        PyObject* self = obj;
+        std::string key = '#' + std::to_string(reinterpret_cast<uintptr_t>(self));
+        detail::cached_handle(key, [&] {
+            Py_INCREF(self);
+            return self;
+        });
+        
+        PyObject* value = detail::cached_handle(key + ':' + attr_name, [&] {
+            return PyObject_GetAttrString(self, attr_name.c_str());
+        });
+        
+        if (!value) {
+            PyErr_Clear();
+            return PyObj();
+        }
+        return PyObj(borrow(value));
+    }
+};
+
+// import name, with the module kept for the life of the interpreter:
+// repeated imports skip sys.modules and the import machinery entirely
+inline Module import(const std::string& name) {
+    PyObject* module = detail::cached_handle(name, [&] {
+        return PyImport_ImportModule(name.c_str());
+    });
+    
+    if (!module) {
+        detail::report_error();
+        return Module();
+    }
+    return Module(borrow(module));
+}
+
+// ================== Async Runtime ==================
+// Owns an asyncio event loop running on its own thread. Python awaitables
+// (coroutines, tasks, futures) are handed to the loop and complete there;
+// many can be in flight at once without a blocked C++ thread each. In
+// C++20 coroutines, co_await async_call(function, args...) resumes the
+// coroutine with expected<PyObj> once the call finishes. Resumption goes
+// through the executor passed to the constructor, or runs inline on the
+// loop thread (GIL held) when there is none. A result resumed elsewhere is
+// a PyObj like any other: touch or drop it with the GIL held.
+class AsyncRuntime {
+public:
+    using Executor = std::function<void(std::function<void()>)>;
+    
+    // Receives the outcome on the loop thread, GIL held; result is a new
+    // reference or null with the error set in failure
+    struct Completion {
+        virtual ~Completion() = default;
+        virtual void complete(PyObject* result, error failure) = 0;
+    };
+    
+    explicit AsyncRuntime(Executor executor = nullptr) : executor(std::move(executor)) {
+        {
+            gil_acquire gil;
+            PyObject* asyncio = PyImport_ImportModule("asyncio");
+            loop = asyncio ? PyObject_CallMethod(asyncio, "new_event_loop", nullptr) : nullptr;
+            Py_XDECREF(asyncio);
+            if (!loop) {
+                detail::report_error();
+                return;
+            }
+        }
+        
+        thread = std::thread([this] {
+            gil_acquire gil;
+            PyObject* result = PyObject_CallMethod(loop, "run_forever", nullptr);
+            if (!result) detail::report_error();
+            Py_XDECREF(result);
+            
+            // Tasks still pending are cancelled, so their awaiters resume;
+            // cancelling can start more tasks, so repeat until none are left
+            PyObject* code = Py_CompileString(
+                "import asyncio\n"
+                "while tasks := asyncio.all_tasks(loop):\n"
+                "    for task in tasks: task.cancel()\n"
+                "    loop.run_until_complete(asyncio.gather(*tasks, return_exceptions=True))\n"
+                "loop.run_until_complete(loop.shutdown_asyncgens())\n"
+                "loop.close()\n", "<AsyncRuntime>", Py_file_input);
+            PyObject* globals = PyDict_New();
+            if (code && globals && PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins()) == 0 &&
+                PyDict_SetItemString(globals, "loop", loop) == 0) {
+                Py_XDECREF(PyEval_EvalCode(code, globals, globals));
+            }
+            if (PyErr_Occurred()) PyErr_Print();
+            Py_XDECREF(code);
+            Py_XDECREF(globals);
+        });
+        
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        active() = this;
+    }
+    
+    ~AsyncRuntime() {
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex());
+            if (active() == this) active() = nullptr;
+        }
+        if (!thread.joinable()) {
+            if (loop) {
+                gil_acquire gil;
+                Py_CLEAR(loop);
+            }
+            return;
+        }
+        
+        {
+            // Under the same GIL hold as the stop request, so every start()
+            // either queued its task before the stop or is refused
+            gil_acquire gil;
+            stopping = true;
+            PyObject* stop = PyObject_GetAttrString(loop, "stop");
+            PyObject* result = stop ? PyObject_CallMethod(loop, "call_soon_threadsafe", "O", stop) : nullptr;
+            if (!result) PyErr_Clear();
+            Py_XDECREF(result);
+            Py_XDECREF(stop);
+        }
+        
+        // The loop thread needs the GIL to wind down
+        if (PyGILState_Check()) {
+            gil_release released;
+            thread.join();
+        } else {
+            thread.join();
+        }
+        
+        gil_acquire gil;
+        Py_CLEAR(loop);
+    }
+    
+    AsyncRuntime(const AsyncRuntime&) = delete;
+    AsyncRuntime& operator=(const AsyncRuntime&) = delete;
+    
+    // The most recently started runtime still alive, used by async_call()
+    static AsyncRuntime* current() {
+        std::lock_guard<std::mutex> lock(registry_mutex());
+        return active();
+    }
+    
+    // Borrowed; the event loop object
+    PyObject* event_loop() const { return loop; }
+    
+    // Schedules an awaitable on the loop; any thread, GIL taken inside.
+    // done must stay alive until complete() is called. Once the runtime is
+    // being destroyed, new awaitables complete at once with a RuntimeError.
+    void start(PyObject* awaitable, Completion* done) {
+        gil_acquire gil;
+        if (!loop || stopping) {
+            // A refused coroutine is closed so it does not warn it was never awaited
+            if (PyCoro_CheckExact(awaitable)) Py_XDECREF(PyObject_CallMethod(awaitable, "close", nullptr));
+            PyErr_Clear();
+            PyErr_SetString(PyExc_RuntimeError, loop ? "AsyncRuntime is shutting down" : "AsyncRuntime has no event loop");
+            done->complete(nullptr, error::fetch());
+            return;
+        }
+        
+        Pending* pending = new Pending{ this, awaitable, done };
+        Py_INCREF(awaitable);
+        
+        // From here the capsule owns pending
+        PyObject* capsule = PyCapsule_New(pending, nullptr, drop);
+        if (!capsule) {
+            error failure = error::fetch();
+            finish(pending, nullptr, std::move(failure));
+            delete pending;
+            return;
+        }
+        
+        PyObject* begin = PyCFunction_New(&begin_def(), capsule);
+        PyObject* result = begin ? PyObject_CallMethod(loop, "call_soon_threadsafe", "O", begin) : nullptr;
+        if (!result) {
+            error failure = error::fetch();
+            finish(pending, nullptr, std::move(failure));
+        }
+        Py_XDECREF(result);
+        Py_XDECREF(begin);
+        Py_DECREF(capsule);
+    }
+    
+    // Calls function(args...) on this thread and runs the awaitable it
+    // returns on the loop; the future is ready when it completes
+    template<typename... Args>
+    std::future<expected<PyObj>> submit(const PyObj& function, Args&&... args) {
+        struct Promised : Completion {
+            std::promise<expected<PyObj>> promise;
+            void complete(PyObject* result, error failure) override {
+                if (result) promise.set_value(expected<PyObj>(PyObj(steal(result))));
+                else promise.set_value(expected<PyObj>(std::move(failure)));
+                delete this;
+            }
+        };
+        
+        Promised* done = new Promised();
+        std::future<expected<PyObj>> future = done->promise.get_future();
+        launch(function, done, std::forward<Args>(args)...);
+        return future;
+    }
+    
+    // Shared by submit() and the awaiter: results that are not awaitable
+    // complete at once
+    template<typename... Args>
+    void launch(const PyObj& function, Completion* done, Args&&... args) {
+        gil_acquire gil;
+        ErrorBatch batch;
+        PyObj value = Function(function)(std::forward<Args>(args)...);
+        
+        if (!batch.empty()) {
+            done->complete(nullptr, batch.take().front());
+            return;
+        }
+        
+        PyObject* o = value.get_obj();
+        PyTypeObject* type = o ? Py_TYPE(o) : nullptr;
+        if (!type || !type->tp_as_async || !type->tp_as_async->am_await) {
+            PyObject* result = o ? o : Py_None;
+            Py_INCREF(result);
+            done->complete(result, error());
+            return;
+        }
+        start(o, done);
+    }
+    
+    void resume(std::function<void()> continuation) {
+        if (executor) executor(std::move(continuation));
+        else continuation();
+    }
+
+private:
+    struct Pending {
+        AsyncRuntime* runtime;
+        PyObject* awaitable;    // strong until the task exists
+        Completion* done;
+    };
+    
+    PyObject* loop = nullptr;
+    Executor executor;
+    std::thread thread;
+    bool stopping = false;  // guarded by the GIL
+    
+    static std::mutex& registry_mutex() {
+        static std::mutex mutex;
+        return mutex;
+    }
+    
+    static AsyncRuntime*& active() {
+        static AsyncRuntime* runtime = nullptr;
+        return runtime;
+    }
+    
+    // Completes at most once; the Pending itself stays with its capsule
+    static void finish(Pending* pending, PyObject* result, error failure) {
+        Py_CLEAR(pending->awaitable);
+        Completion* done = std::exchange(pending->done, nullptr);
+        if (done) done->complete(result, std::move(failure));
+        else Py_XDECREF(result);
+    }
+    
+    // Capsule destructor: a callback the loop dropped unrun (it was closed
+    // first) still completes, so no awaiter waits forever
+    static void drop(PyObject* capsule) {
+        Pending* pending = static_cast<Pending*>(PyCapsule_GetPointer(capsule, nullptr));
+        if (!pending) {
+            PyErr_Clear();
+            return;
+        }
+        
+        if (pending->done) {
+            PyObject *type, *value, *traceback;
+            PyErr_Fetch(&type, &value, &traceback);
+            PyErr_SetString(PyExc_RuntimeError, "AsyncRuntime stopped before the awaitable ran");
+            error failure = error::fetch();
+            finish(pending, nullptr, std::move(failure));
+            PyErr_Restore(type, value, traceback);
+        }
+        Py_CLEAR(pending->awaitable);
+        delete pending;
+    }
+    
+    // Runs on the loop: wraps the awaitable in a task and hooks its end
+    static PyObject* begin(PyObject* capsule, PyObject*) {
+        Pending* pending = static_cast<Pending*>(PyCapsule_GetPointer(capsule, nullptr));
+        
+        PyObj ensure_future = import("asyncio").attr("ensure_future");
+        PyObject* task = ensure_future.get_obj() 
+            ? PyObject_CallFunctionObjArgs(ensure_future.get_obj(), pending->awaitable, nullptr) 
+            : nullptr;
+        
+        PyObject* hook = task ? PyCFunction_New(&end_def(), capsule) : nullptr;
+        PyObject* added = hook ? PyObject_CallMethod(task, "add_done_callback", "O", hook) : nullptr;
+        Py_XDECREF(hook);
+        Py_XDECREF(task);
+        
+        if (!added) {
+            error failure = error::fetch();
+            finish(pending, nullptr, std::move(failure));
+        }
+        Py_XDECREF(added);
+        Py_RETURN_NONE;
+    }
+    
+    static PyObject* end(PyObject* capsule, PyObject* task) {
+        Pending* pending = static_cast<Pending*>(PyCapsule_GetPointer(capsule, nullptr));
+        
+        // Task.result() re-raises the exception or CancelledError
+        PyObject* result = PyObject_CallMethod(task, "result", nullptr);
+        error failure;
+        if (!result) failure = error::fetch();
+        finish(pending, result, std::move(failure));
+        Py_RETURN_NONE;
+    }
+    
+    static PyMethodDef& begin_def() {
+        static PyMethodDef def = { "begin", begin, METH_NOARGS, nullptr };
+        return def;
+    }
+    
+    static PyMethodDef& end_def() {
+        static PyMethodDef def = { "end", end, METH_O, nullptr };
+        return def;
+    }
+};
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+namespace detail {
+// Refers to the function and arguments it was made from, which live until
+// the end of the co_await expression
+template<typename... Args>
+class AsyncCall : public AsyncRuntime::Completion {
+    AsyncRuntime* runtime;
+    const PyObj& function;
+    std::tuple<Args&&...> args;
+    std::coroutine_handle<> waiting;
+    std::optional<expected<PyObj>> outcome;
+    // Whichever of await_suspend() and complete() finishes second resumes
+    std::atomic<bool> settled{ false };
+
+public:
+    AsyncCall(AsyncRuntime* runtime, const PyObj& function, Args&&... args) 
+        : runtime(runtime), function(function), args(std::forward<Args>(args)...) {}
+    
+    bool await_ready() const { return false; }
+    
+    bool await_suspend(std::coroutine_handle<> handle) {
+        waiting = handle;
+        if (!runtime) {
+            gil_acquire gil;
+            PyErr_SetString(PyExc_RuntimeError, "async_call: no AsyncRuntime is running");
+            outcome.emplace(error::fetch());
+            return false;
+        }
+        
+        std::apply([this](auto&&... values) { 
+            runtime->launch(function, this, std::forward<decltype(values)>(values)...); 
+        }, std::move(args));
+        return !settled.exchange(true);
+    }
+    
+    expected<PyObj> await_resume() { return std::move(*outcome); }
+    
+    void complete(PyObject* result, error failure) override {
+        if (result) outcome.emplace(PyObj(steal(result)));
+        else outcome.emplace(std::move(failure));
+        
+        if (!settled.exchange(true)) return;
+        std::coroutine_handle<> handle = waiting;
+        runtime->resume([handle] { handle.resume(); });
+    }
+};
+} // end namespace detail
+
+// co_await async_call(function, args...) -> expected<PyObj>, on the given
+// runtime or the current one
+template<typename... Args>
+detail::AsyncCall<Args...> async_call(AsyncRuntime& runtime, const PyObj& function, Args&&... args) {
+    return detail::AsyncCall<Args...>(&runtime, function, std::forward<Args>(args)...);
+}
+
+template<typename... Args>
+detail::AsyncCall<Args...> async_call(const PyObj& function, Args&&... args) {
+    return detail::AsyncCall<Args...>(AsyncRuntime::current(), function, std::forward<Args>(args)...);
+}
+#endif
+
+// ================== Formatted String ==================
+template<typename T>
+std::pair<std::string, std::string> farg(const std::string& name, T&& value) {
+    std::ostringstream os; 
+    os << value; 
+    return {name, os.str()};
+}
+
+template<typename... Args>
+std::string fstring(const std::string& format, Args&&... args) {
+    std::unordered_map<std::string, std::string> named_args;
+    std::vector<std::string> positional_args;
+    
+    auto process_arg = [&](auto&& arg) {
+        using ArgType = std::decay_t<decltype(arg)>;
+        
+        if constexpr (std::is_same_v<ArgType, std::pair<std::string, std::string>>) {
+            named_args.emplace(arg.first, arg.second);
+        } else {
+            std::ostringstream os; 
+            os << arg; 
+            positional_args.push_back(os.str());
+        }
+    };
+    
+    (process_arg(std::forward<Args>(args)), ...);
+    
+    std::string output;
+    output.reserve(format.size() + 32);
+    size_t position_index = 0;
+    
+    for (size_t i = 0; i < format.size(); ++i) {
+        if (format[i] == '{') {
+            // Handle escaped braces
+            if (i + 1 < format.size() && format[i + 1] == '{') {
+                output.push_back('{');
+                ++i;
+                continue;
+            }
+            
+            // Find closing brace
+            size_t j = format.find('}', i + 1);
+            if (j == std::string::npos) {
+                output.push_back('{');
+                continue;
+            }
+            
+            std::string key = format.substr(i + 1, j - i - 1);
+            
+            // Handle empty key (positional) or named key
+            if (key.empty()) {
+                if (position_index < positional_args.size()) {
+                    output += positional_args[position_index++];
+                } else {
+                    output += "{}";
+                }
+            } else {
+                auto it = named_args.find(key);
+                if (it != named_args.end()) {
+                    output += it->second;
+                } else {
+                    output += "{" + key + "}";
+                }
+            }
+            
+            i = j;
+        } else if (format[i] == '}') {
+            // Handle escaped braces
+            if (i + 1 < format.size() && format[i + 1] == '}') {
+                output.push_back('}');
+                ++i;
+            } else {
+                output.push_back('}');
+            }
+        } else {
+            output.push_back(format[i]);
+        }
+    }
+    
+    return output;
+}
+
+// ================== Pretty Print Implementation ==================
+namespace detail {
+// Writes value the way float.__repr__ does, without a Python object.
+// out needs room for 32 characters.
+inline size_t format_float(char* out, double value) {
+    if (value != value) { std::memcpy(out, "nan", 3); return 3; }
+    if (value == std::numeric_limits<double>::infinity()) { std::memcpy(out, "inf", 3); return 3; }
+    if (value == -std::numeric_limits<double>::infinity()) { std::memcpy(out, "-inf", 4); return 4; }
+    
+#if defined(__cpp_lib_to_chars)
+    // Shortest round-trip digits, then laid out with repr's rule: plain
+    // notation for exponents in [-4, 16), scientific otherwise
+    char scientific[32];
+    char* end = std::to_chars(scientific, scientific + sizeof(scientific), value, std::chars_format::scientific).ptr;
+    
+    const char* p = scientific;
+    char* o = out;
+    if (*p == '-') *o++ = *p++;
+    
+    char digits[20];
+    size_t count = 0;
+    while (*p != 'e') {
+        if (*p != '.') digits[count++] = *p;
+        ++p;
+    }
+    
+    // to_chars does not NUL-terminate, so the exponent is read up to end
+    bool negative = *++p == '-';
+    int exponent = 0;
+    for (++p; p < end; ++p) exponent = exponent * 10 + (*p - '0');
+    if (negative) exponent = -exponent;
+    
+    if (exponent < -4 || exponent >= 16) {
+        size_t size = end - scientific;
+        std::memcpy(out, scientific, size);
+        return size;
+    }
+    
+    if (exponent < 0) {
+        *o++ = '0';
+        *o++ = '.';
+        for (int i = -1; i > exponent; --i) *o++ = '0';
+        std::memcpy(o, digits, count);
+        return o + count - out;
+    }
+    
+    size_t whole = static_cast<size_t>(exponent) + 1;
+    for (size_t i = 0; i < whole; ++i) *o++ = i < count ? digits[i] : '0';
+    *o++ = '.';
+    if (count > whole) {
+        std::memcpy(o, digits + whole, count - whole);
+        o += count - whole;
+    } else {
+        *o++ = '0';
+    }
+    return o - out;
+#else
+    char* text = PyOS_double_to_string(value, 'r', 0, Py_DTSF_ADD_DOT_0, nullptr);
+    if (!text) {
+        PyErr_Clear();
+        return 0;
+    }
+    size_t size = std::strlen(text);
+    std::memcpy(out, text, size);
+    PyMem_Free(text);
+    return size;
+#endif
+}
+
+// Collects output and hands it to an ostream or a file descriptor in large
+// writes, so formatting never goes through per-item stream calls
+class OutputBuffer {
+public:
+    explicit OutputBuffer(std::ostream& os) : stream(&os) { buffer.reserve(capacity); }
+    explicit OutputBuffer(int fd) : fd(fd) { buffer.reserve(capacity); }
+    ~OutputBuffer() { flush(); }
+    
+    OutputBuffer(const OutputBuffer&) = delete;
+    OutputBuffer& operator=(const OutputBuffer&) = delete;
+    
+    void write(const char* data, size_t size) {
+        if (buffer.size() + size > capacity) flush();
+        if (size >= capacity) sink(data, size);
+        else buffer.append(data, size);
+    }
+    
+    void write(std::string_view text) { write(text.data(), text.size()); }
+    
+    void put(char c) {
+        if (buffer.size() == capacity) flush();
+        buffer.push_back(c);
+    }
+    
+    void spaces(int count) {
+        static const std::string run(64, ' ');
+        for (; count > 0; count -= 64) write(run.data(), std::min(count, 64));
+    }
+    
+    void write_int(long long value) {
+        char digits[24];
+        write(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr - digits);
+    }
+    
+    void write_float(double value) {
+        char digits[32];
+        write(digits, format_float(digits, value));
+    }
+    
+    void flush() {
+        if (buffer.empty()) return;
+        sink(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+
+private:
+    static constexpr size_t capacity = 1 << 16;
+    
+    std::string buffer;
+    std::ostream* stream = nullptr;
+    int fd = -1;
+    
+    void sink(const char* data, size_t size) {
+        if (stream) {
+            stream->write(data, size);
+            return;
+        }
+        
+        while (size > 0) {
+#ifdef _WIN32
+            int written = _write(fd, data, static_cast<unsigned>(std::min<size_t>(size, 1u << 30)));
+            if (written < 0) return;
+#else
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+#endif
+            data += written;
+            size -= written;
+        }
+    }
+};
+
+// Walks containers with an explicit stack, so deep nesting costs no C
+// stack and children are read as borrowed pointers. Each open container
+// holds a reference to itself (and to a dict value still to be written).
+struct PrettyFrame {
+    PyObject* container;
+    PyObject* iterator;  // sets only
+    PyObject* pending;   // dict value waiting for its key to finish
+    Py_ssize_t pos;
+    int indent;
+    char close;
+    bool first;
+};
+
+inline void write_repr(OutputBuffer& out, PyObject* object) {
+    PyObject* repr = PyObject_Repr(object);
+    std::string_view text = repr ? unicode_view(repr) : std::string_view();
+    
+    if (text.data()) out.write(text);
+    else {
+        PyErr_Clear();
+        out.write(repr ? "<repr-error>" : "<PyObj>");
+    }
+    Py_XDECREF(repr);
+}
+
+inline void pretty_print(OutputBuffer& out, PyObject* root, int indent = 0) {
+    std::vector<PrettyFrame> stack;
+    
+    // Scalars are written at once, non-empty containers open a frame
+    auto emit = [&](PyObject* object, int level) {
+        if (!object || object == Py_None) { out.write("None", 4); return; }
+        if (object == Py_True) { out.write("True", 4); return; }
+        if (object == Py_False) { out.write("False", 5); return; }
+        
+        if (PyLong_Check(object)) {
+            int overflow = 0;
+            long long value = PyLong_AsLongLongAndOverflow(object, &overflow);
+            if (overflow || (value == -1 && PyErr_Occurred())) {
+                PyErr_Clear();
+                write_repr(out, object);
+            } else {
+                out.write_int(value);
+            }
+            return;
+        }
+        
+        if (PyFloat_Check(object)) { out.write_float(PyFloat_AS_DOUBLE(object)); return; }
+        
+        if (PyUnicode_Check(object)) {
+            std::string_view text = unicode_view(object);
+            if (!text.data()) PyErr_Clear();
+            out.put('"');
+            out.write(text);
+            out.put('"');
+            return;
+        }
+        
+        PrettyFrame frame{object, nullptr, nullptr, 0, level, 0, true};
+        if (PyList_Check(object)) {
+            if (PyList_GET_SIZE(object) == 0) { out.write("[]", 2); return; }
+            out.write("[\n", 2);
+            frame.close = ']';
+        } else if (PyTuple_Check(object)) {
+            if (PyTuple_GET_SIZE(object) == 0) { out.write("()", 2); return; }
+            out.write("(\n", 2);
+            frame.close = ')';
+        } else if (PyDict_Check(object)) {
+            if (PyDict_GET_SIZE(object) == 0) { out.write("{}", 2); return; }
+            out.write("{\n", 2);
+            frame.close = '}';
+        } else if (PySet_Check(object)) {
+            frame.iterator = PyObject_GetIter(object);
+            if (!frame.iterator) {
+                PyErr_Clear();
+                out.write("<set>", 5);
+                return;
+            }
+            out.write("{\n", 2);
+            frame.close = '}';
+        } else {
+            write_repr(out, object);
+            return;
+        }
+        
+        Py_INCREF(object);
+        stack.push_back(frame);
+    };
+    
+    emit(root, indent);
+    
+    while (!stack.empty()) {
+        PrettyFrame& frame = stack.back();
+        int level = frame.indent + 4;
+        
+        if (frame.pending) {
+            PyObject* value = frame.pending;
+            frame.pending = nullptr;
+            out.write(": ", 2);
+            emit(value, level);
+            Py_DECREF(value);
+            continue;
+        }
+        
+        PyObject* child = nullptr;
+        PyObject* value = nullptr;
+        PyObject* owned = nullptr;
+        PyObject* container = frame.container;
+        
+        if (PyList_Check(container)) {
+            if (frame.pos < PyList_GET_SIZE(container)) child = PyList_GET_ITEM(container, frame.pos++);
+        } else if (PyTuple_Check(container)) {
+            if (frame.pos < PyTuple_GET_SIZE(container)) child = PyTuple_GET_ITEM(container, frame.pos++);
+        } else if (frame.iterator) {
+            child = owned = PyIter_Next(frame.iterator);
+            if (!child) PyErr_Clear();
+        } else {
+            if (!PyDict_Next(container, &frame.pos, &child, &value)) child = nullptr;
+        }
+        
+        if (!child) {
+            out.put('\n');
+            out.spaces(frame.indent);
+            out.put(frame.close);
+            
+            Py_XDECREF(frame.iterator);
+            Py_DECREF(container);
+            stack.pop_back();
+            continue;
+        }
+        
+        if (!frame.first) out.write(",\n", 2);
+        frame.first = false;
+        out.spaces(level);
+        
+        // emit() may grow the stack, so frame is not used past this point
+        if (value) {
+            Py_INCREF(value);
+            frame.pending = value;
+        }
+        emit(child, level);
+        Py_XDECREF(owned);
+    }
+}
+
+} // end namespace detail
+
+// ================== Output Operators ==================
+inline std::ostream& operator<<(std::ostream& os, const PyObj& obj) {
+    PyObject* object = obj.get_obj();
+    if (!object || object == Py_None) return os.write("None", 4);
+    if (object == Py_True) return os.write("True", 4);
+    if (object == Py_False) return os.write("False", 5);
+    
+    char digits[32];
+    if (PyLong_CheckExact(object)) {
+        int overflow = 0;
+        long long value = PyLong_AsLongLongAndOverflow(object, &overflow);
+        if (!overflow) return os.write(digits, std::to_chars(digits, digits + sizeof(digits), value).ptr - digits);
+    }
+    
+    if (PyFloat_CheckExact(object)) 
+        return os.write(digits, detail::format_float(digits, PyFloat_AS_DOUBLE(object)));
+    
+    PyObject* repr = PyObject_Repr(object);
+    std::string_view text = repr ? detail::unicode_view(repr) : std::string_view();
+    
+    if (text.data()) os.write(text.data(), text.size());
+    else {
+        PyErr_Clear();
+        os << "<PyObj>";
+    }
+    Py_XDECREF(repr);
+    
+    return os;
+}
+
+// ================== Compiled Format Strings ==================
+#if __cplusplus >= 202002L
+// fstring<"user={name} n={}">(farg<"name">(user), n) parses the format at
+// compile time, resolves every placeholder to its argument up front and
+// sizes the output once. Same grammar as fstring(format, ...). Numbers go
+// through std::to_chars (same text as the stream-based fstring), PyObj
+// arguments are written like str() in a Python f-string: str objects are
+// copied straight from their UTF-8 view.
+namespace detail {
+template<size_t N>
+struct FormatLiteral {
+    char text[N]{};
+    
+    constexpr FormatLiteral(const char (&literal)[N]) {
+        for (size_t i = 0; i < N; ++i) text[i] = literal[i];
+    }
+    
+    constexpr std::string_view view() const { return {text, N - 1}; }
+};
+
+template<FormatLiteral Name, typename T>
+struct NamedArg {
+    const T& value;
+};
+
+// Literal text, or a placeholder including its braces
+struct FormatSegment {
+    size_t begin = 0;
+    size_t length = 0;
+    bool placeholder = false;
+};
+
+// Fills up to capacity segments and returns how many the format has
+constexpr size_t parse_format(std::string_view format, FormatSegment* out, size_t capacity) {
+    size_t count = 0;
+    auto add = [&](size_t begin, size_t length, bool placeholder) {
+        if (!placeholder && length == 0) return;
+        if (out && count < capacity) out[count] = {begin, length, placeholder};
+        ++count;
+    };
+    
+    size_t run = 0;
+    for (size_t i = 0; i < format.size(); ++i) {
+        bool doubled = i + 1 < format.size() && format[i + 1] == format[i];
+        
+        if (format[i] == '{' && !doubled) {
+            size_t close = format.find('}', i + 1);
+            if (close == std::string_view::npos) continue;  // a lone '{' stays text
+            
+            add(run, i - run, false);
+            add(i, close - i + 1, true);
+            run = close + 1;
+            i = close;
+        } else if ((format[i] == '{' || format[i] == '}') && doubled) {
+            // Keep one brace of the pair in the run, drop the other
+            add(run, i + 1 - run, false);
+            run = i + 2;
+            ++i;
+        }
+    }
+    add(run, format.size() - run, false);
+    return count;
+}
+
+template<typename T>
+struct FormatArgTraits {
+    static constexpr bool named = false;
+    static constexpr bool runtime_named = false;
+    static constexpr std::string_view name{};
+};
+
+template<FormatLiteral Name, typename T>
+struct FormatArgTraits<NamedArg<Name, T>> {
+    static constexpr bool named = true;
+    static constexpr bool runtime_named = false;
+    static constexpr std::string_view name = Name.view();
+};
+
+template<>
+struct FormatArgTraits<std::pair<std::string, std::string>> {
+    static constexpr bool named = true;
+    static constexpr bool runtime_named = true;
+    static constexpr std::string_view name{};
+};
+
+constexpr int format_no_arg = -1;       // written back as "{name}"
+constexpr int format_runtime_arg = -2;  // looked up among farg("name", ...) pairs
+
+template<FormatLiteral F>
+struct ParsedFormat {
+    static constexpr size_t count = parse_format(F.view(), nullptr, 0);
+    
+    static constexpr std::array<FormatSegment, count> segments = [] {
+        std::array<FormatSegment, count> result{};
+        parse_format(F.view(), result.data(), count);
+        return result;
+    }();
+    
+    // Argument index of every placeholder, resolved against the argument types
+    template<typename... Args>
+    static constexpr std::array<int, count> resolve() {
+        constexpr bool named[] = { false, FormatArgTraits<std::decay_t<Args>>::named... };
+        constexpr bool runtime_named[] = { false, FormatArgTraits<std::decay_t<Args>>::runtime_named... };
+        constexpr std::string_view names[] = { std::string_view(), FormatArgTraits<std::decay_t<Args>>::name... };
+        constexpr size_t arity = sizeof...(Args);
+        
+        std::array<int, count> result{};
+        size_t next_positional = 0;
+        
+        for (size_t s = 0; s < count; ++s) {
+            result[s] = format_no_arg;
+            if (!segments[s].placeholder) continue;
+            
+            if (key(s).empty()) {
+                for (size_t seen = 0, a = 0; a < arity; ++a) {
+                    if (named[a + 1]) continue;
+                    if (seen++ == next_positional) {
+                        result[s] = static_cast<int>(a);
+                        break;
+                    }
+                }
+                ++next_positional;
+                continue;
+            }
+            
+            for (size_t a = 0; a < arity; ++a) {
+                if (runtime_named[a + 1]) result[s] = format_runtime_arg;
+                else if (named[a + 1] && names[a + 1] == key(s)) {
+                    result[s] = static_cast<int>(a);
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+    
+    static constexpr std::string_view key(size_t s) {
+        return F.view().substr(segments[s].begin + 1, segments[s].length - 2);
+    }
+    
+    static constexpr size_t literal_size() {
+        size_t size = 0;
+        for (const FormatSegment& segment : segments) {
+            if (!segment.placeholder) size += segment.length;
+        }
+        return size;
+    }
+};
+
+// Text of one argument; numbers are formatted into the inline buffer and
+// strings are viewed in place
+struct FormattedArg {
+    char digits[32];
+    std::string_view text;
+    std::string_view name;       // farg("name", ...) pairs
+    std::string storage;         // streamed fallback
+    PyObject* owned = nullptr;   // str() result the view points into
+    
+    FormattedArg() = default;
+    FormattedArg(const FormattedArg&) = delete;
+    FormattedArg& operator=(const FormattedArg&) = delete;
+    ~FormattedArg() { Py_XDECREF(owned); }
+};
+
+template<typename T>
+inline void format_arg(FormattedArg& out, const T& value) {
+    using U = std::decay_t<T>;
+    
+    if constexpr (FormatArgTraits<U>::runtime_named) {
+        out.name = value.first;
+        out.text = value.second;
+    } else if constexpr (FormatArgTraits<U>::named) {
+        format_arg(out, value.value);
+    } else if constexpr (std::is_same_v<U, bool>) {
+        out.text = value ? "1" : "0";
+    } else if constexpr (std::is_same_v<U, char>) {
+        out.digits[0] = value;
+        out.text = std::string_view(out.digits, 1);
+    } else if constexpr (std::is_integral_v<U>) {
+        out.text = std::string_view(out.digits, std::to_chars(out.digits, out.digits + sizeof(out.digits), value).ptr - out.digits);
+    } else if constexpr (std::is_floating_point_v<U>) {
+        // %g with six digits, the default stream formatting
+        auto result = std::to_chars(out.digits, out.digits + sizeof(out.digits), value, std::chars_format::general, 6);
+        out.text = std::string_view(out.digits, result.ptr - out.digits);
+    } else if constexpr (std::is_convertible_v<const U&, std::string_view>) {
+        if constexpr (std::is_pointer_v<U>) {
+            if (!value) return;
+        }
+        out.text = std::string_view(value);
+    } else if constexpr (std::is_base_of_v<PyObj, U>) {
+        PyObject* object = value.get_obj();
+        if (!object || object == Py_None) out.text = "None";
+        else if (object == Py_True) out.text = "True";
+        else if (object == Py_False) out.text = "False";
+        else if (PyLong_CheckExact(object)) {
+            int overflow = 0;
+            long long number = PyLong_AsLongLongAndOverflow(object, &overflow);
+            if (!overflow) {
+                out.text = std::string_view(out.digits, std::to_chars(out.digits, out.digits + sizeof(out.digits), number).ptr - out.digits);
+                return;
+            }
+        } else if (PyFloat_CheckExact(object)) {
+            out.text = std::string_view(out.digits, format_float(out.digits, PyFloat_AS_DOUBLE(object)));
+            return;
+        }
+        if (!out.text.empty()) return;
+        
+        if (PyUnicode_Check(object)) out.text = unicode_view(object);
+        else if ((out.owned = PyObject_Str(object))) out.text = unicode_view(out.owned);
+        
+        if (!out.text.data()) PyErr_Clear();
+    } else {
+        std::ostringstream os;
+        os << value;
+        out.storage = os.str();
+        out.text = out.storage;
+    }
+}
+
+template<FormatLiteral F, typename... Args, size_t... I>
+inline std::string compiled_fstring(std::index_sequence<I...>, const Args&... args) {
+    using Format = ParsedFormat<F>;
+    static constexpr auto targets = Format::template resolve<Args...>();
+    constexpr std::string_view format = F.view();
+    
+    FormattedArg slots[sizeof...(Args) + 1];
+    (format_arg(slots[I], args), ...);
+    
+    auto runtime_arg = [&](std::string_view key) -> const FormattedArg* {
+        for (size_t a = 0; a < sizeof...(Args); ++a) {
+            if (slots[a].name.data() && slots[a].name == key) return &slots[a];
+        }
+        return nullptr;
+    };
+    
+    auto placeholder_text = [&](size_t s) -> std::string_view {
+        const FormatSegment& segment = Format::segments[s];
+        const FormattedArg* arg = nullptr;
+        if (targets[s] >= 0) arg = &slots[targets[s]];
+        else if (targets[s] == format_runtime_arg) arg = runtime_arg(Format::key(s));
+        
+        // An unmatched placeholder is written back as it was
+        return arg ? arg->text : format.substr(segment.begin, segment.length);
+    };
+    
+    size_t size = Format::literal_size();
+    for (size_t s = 0; s < Format::count; ++s) {
+        if (Format::segments[s].placeholder) size += placeholder_text(s).size();
+    }
+    
+    std::string output;
+    output.reserve(size);
+    for (size_t s = 0; s < Format::count; ++s) {
+        const FormatSegment& segment = Format::segments[s];
+        if (segment.placeholder) output.append(placeholder_text(s));
+        else output.append(format.data() + segment.begin, segment.length);
+    }
+    return output;
+}
+} // end namespace detail
+
+template<detail::FormatLiteral Name, typename T>
+detail::NamedArg<Name, std::decay_t<T>> farg(const T& value) {
+    return {value};
+}
+
+template<detail::FormatLiteral F, typename... Args>
+std::string fstring(const Args&... args) {
+    return detail::compiled_fstring<F>(std::index_sequence_for<Args...>{}, args...);
+}
+#endif
+
+// ================== Global Functions ==================
+inline Str type(const PyObj& obj) { 
+    if (!obj.get_obj()) return Str("<NoneType>"); 
+    
+    PyObject* type_obj = PyObject_Type(obj.get_obj()); 
+    if (!type_obj) return Str("<unknown>"); 
+    
+    PyObject* name = PyObject_GetAttrString(type_obj, "__name__"); 
+    Py_XDECREF(type_obj); 
+    
+    if (!name) return Str("<unknown>"); 
+    
+    const char* type_name = PyUnicode_AsUTF8(name); 
+    Str result(type_name ? type_name : "<unknown>"); 
+    Py_XDECREF(name); 
+    
+    return result; 
+}
+
+inline long len(const PyObj& obj) {
+    if (!obj.get_obj()) return 0;
+    
+    if (obj.is_str()) return PyUnicode_GetLength(obj.get_obj());
+    if (obj.is_list()) return PyList_Size(obj.get_obj());
+    if (obj.is_tuple()) return PyTuple_Size(obj.get_obj());
+    if (obj.is_set()) return PySet_Size(obj.get_obj());
+    if (obj.is_dict()) return PyDict_Size(obj.get_obj());
+    
+    return 0;
+}
+
+// A new sorted list, as sorted(sequence, key=key, reverse=reverse)
+inline List sorted(const PyObj& sequence, const PyObj& key = PyObj(), bool reverse = false) {
+    if (!sequence.get_obj()) return List();
+    
+    PyObject* temp_list = PySequence_List(sequence.get_obj());
+    if (!temp_list) { 
+        PyErr_Clear(); 
+        return List(); 
+    }
+    
+    if (!detail::sort_list(temp_list, key.get_obj(), reverse)) {
+        Py_DECREF(temp_list);
+        return List();
+    }
+    return List(steal(temp_list));
+}
+
+// A new list sorted by native T keys, see List::sort_by()
+template<typename T, typename F>
+List sorted_by(const PyObj& sequence, F&& extractor, bool reverse = false) {
+    if (!sequence.get_obj()) return List();
+    
+    List output(steal(PySequence_List(sequence.get_obj())));
+    if (!output.get_obj()) {
+        PyErr_Clear();
+        return List();
+    }
+    
+    if (!output.sort_by<T>(extractor, reverse)) return List();
+    return output;
+}
+
+inline PyObj reversed(const PyObj& obj) {
+    if (!obj.get_obj()) return PyObj();
+    
+    if (obj.is_str()) {
+        PyObject* sequence = PySequence_List(obj.get_obj()); 
+        if (!sequence || PyList_Reverse(sequence) < 0) { 
+            Py_XDECREF(sequence);
+            PyErr_Clear(); 
+            return PyObj(); 
+        }
+        
+        PyObject* separator = PyUnicode_FromString("");
+        PyObject* joined = PyUnicode_Join(separator, sequence); 
+        Py_XDECREF(separator);
+        Py_XDECREF(sequence);
+        
+        return PyObj(steal(joined));
+    }
+    
+    if (obj.is_list() || obj.is_tuple()) {
+        PyObject* sequence = PySequence_List(obj.get_obj()); 
+        if (!sequence || PyList_Reverse(sequence) < 0) { 
+            Py_XDECREF(sequence);
+            PyErr_Clear(); 
+            return PyObj(); 
+        }
+        
+        if (obj.is_tuple()) {
+            PyObject* tuple = PySequence_Tuple(sequence); 
+            Py_XDECREF(sequence); 
+            return PyObj(steal(tuple)); 
+        }
+        
+        return PyObj(steal(sequence));
+    }
+    
+    PyErr_Clear();
+    return PyObj();
+}
+
+inline void PyObj::pretty_print(std::ostream& os, const PyObj& obj, int indent) { 
+    detail::OutputBuffer out(os);
+    detail::pretty_print(out, obj.get_obj(), indent); 
+}
+
+inline void print(const PyObj& obj = Str("\\n")) {
+    if (obj.str() != "\\n")
+        std::cout << obj << std::endl;
+    else
+        std::cout << std::endl;
+}
+
+inline void pprint(const PyObj& obj, int indent = 0) {
+    PyObj::pretty_print(std::cout, obj, indent);
+    std::cout << std::endl;
+}
+
+// Same as pprint(), written straight to a file descriptor in large chunks
+inline void pprint_fd(int fd, const PyObj& obj, int indent = 0) {
+    detail::OutputBuffer out(fd);
+    detail::pretty_print(out, obj.get_obj(), indent);
+    out.put('\n');
+}
+
+// ================== Utility Functions ==================
+inline bool all(const List& list) { 
+    if (detail::scannable(list.get_obj())) {
+        Py_ssize_t falsy = detail::find_truth(list.get_obj(), false);
+        if (falsy < 0) PyErr_Clear();
+        return falsy == PySequence_Fast_GET_SIZE(list.get_obj());
+    }
+    
+    for (long i = 0; i < list.len(); ++i) 
+        if (!PyObject_IsTrue(list[i].get_obj())) 
+            return false; 
+    return true; 
+}
+
+inline bool any(const List& list) { 
+    if (detail::scannable(list.get_obj())) {
+        Py_ssize_t truthy = detail::find_truth(list.get_obj(), true);
+        if (truthy < 0) PyErr_Clear();
+        return truthy >= 0 && truthy < PySequence_Fast_GET_SIZE(list.get_obj());
+    }
+    
+    for (long i = 0; i < list.len(); ++i) 
+        if (PyObject_IsTrue(list[i].get_obj())) 
+            return true; 
+    return false; 
+}
+
+inline bool all(const Tuple& tuple) { return all(List(borrow(tuple.get_obj()))); }
+inline bool any(const Tuple& tuple) { return any(List(borrow(tuple.get_obj()))); }
+
+// Unboxed numeric data is tested a block at a time so the compiler can
+// vectorize the compares; the early exit is checked once per block
+template<typename T>
+bool all(const Buffer<T>& buffer) {
+    using U = std::remove_const_t<T>;
+    const U* data = buffer.data();
+    size_t size = buffer.size(), i = 0;
+    
+    for (; i + 64 <= size; i += 64) {
+        unsigned zeros = 0;
+        for (size_t j = 0; j < 64; ++j) zeros |= data[i + j] == U(0);
+        if (zeros) return false;
+    }
+    for (; i < size; ++i) 
+        if (data[i] == U(0)) return false;
+    return true;
+}
+
+template<typename T>
+bool any(const Buffer<T>& buffer) {
+    using U = std::remove_const_t<T>;
+    const U* data = buffer.data();
+    size_t size = buffer.size(), i = 0;
+    
+    for (; i + 64 <= size; i += 64) {
+        unsigned nonzeros = 0;
+        for (size_t j = 0; j < 64; ++j) nonzeros |= data[i + j] != U(0);
+        if (nonzeros) return true;
+    }
+    for (; i < size; ++i) 
+        if (data[i] != U(0)) return true;
+    return false;
+}
+
+template<typename T>
+size_t count(const Buffer<T>& buffer, std::remove_const_t<T> value) {
+    const std::remove_const_t<T>* data = buffer.data();
+    size_t size = buffer.size(), total = 0;
+    
+    for (size_t i = 0; i < size; ++i) total += data[i] == value;
+    return total;
+}
+
+// Calls a Python callable once per item through vectorcall. The output
+// lines up with the input by index: an item whose call fails maps to None,
+// its error going through the error policy (or the active ErrorBatch).
+inline List map(const PyObj& function, const List& list) { 
+    PyObject* fast = list.get_obj() ? PySequence_Fast(list.get_obj(), "map: expected a sequence") : nullptr;
+    if (!fast || !function.get_obj()) {
+        Py_XDECREF(fast);
+        PyErr_Clear();
+        return List();
+    }
+    PyObj sequence(steal(fast));
+    
+    Py_ssize_t size = PySequence_Fast_GET_SIZE(fast);
+    List output(steal(PyList_New(size)));
+    if (!output.get_obj()) {
+        detail::report_error();
+        return List();
+    }
+    
+    for (Py_ssize_t i = 0; i < size; ++i) {
+        // The callable may shrink the list under us, so re-read each round
+        PyObject* result = nullptr;
+        if (i < PySequence_Fast_GET_SIZE(fast)) {
+            PyObject* stack[2] = { nullptr, PySequence_Fast_ITEMS(fast)[i] };
+            Py_INCREF(stack[1]);
+            result = PyObject_Vectorcall(function.get_obj(), stack + 1, 1 | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr);
+            Py_DECREF(stack[1]);
+        }
+        
+        if (!result) {
+            detail::report_error();
+            result = Py_None;
+            Py_INCREF(result);
+        }
+        PyList_SET_ITEM(output.get_obj(), i, result);
+    }
+    
+    return output; 
+}
+
+namespace detail {
+// Argument type of a plain function or a non-generic lambda/functor
+template<typename F, typename Enable = void>
+struct callable_argument {};
+
+template<typename R, typename A>
+struct callable_argument<R(*)(A)> { using type = A; };
+template<typename R, typename A>
+struct callable_argument<R(*)(A) noexcept> { using type = A; };
+template<typename R, typename A>
+struct callable_argument<R(A)> { using type = A; };
+template<typename R, typename A>
+struct callable_argument<R(A) noexcept> { using type = A; };
+
+template<typename M>
+struct member_argument {};
+template<typename R, typename C, typename A>
+struct member_argument<R(C::*)(A)> { using type = A; };
+template<typename R, typename C, typename A>
+struct member_argument<R(C::*)(A) const> { using type = A; };
+template<typename R, typename C, typename A>
+struct member_argument<R(C::*)(A) noexcept> { using type = A; };
+template<typename R, typename C, typename A>
+struct member_argument<R(C::*)(A) const noexcept> { using type = A; };
+
+template<typename F>
+struct callable_argument<F, std::void_t<decltype(&F::operator())>> : member_argument<decltype(&F::operator())> {};
+
+template<typename F>
+using callable_argument_t = std::decay_t<typename callable_argument<std::decay_t<F>>::type>;
+
+// Splits [0, size) into one contiguous chunk per thread, the last chunk
+// running on the caller. Small inputs stay on the calling thread.
+template<typename Body>
+void parallel_for(size_t size, unsigned threads, Body&& body) {
+    constexpr size_t min_chunk = 16384;
+    
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(std::min<size_t>(threads, std::max<size_t>(1, size / min_chunk)));
+    if (threads <= 1) {
+        body(size_t(0), size);
+        return;
+    }
+    
+    std::vector<std::thread> workers;
+    std::exception_ptr failure;
+    std::mutex failure_mutex;
+    auto run = [&](size_t begin, size_t end) {
+        try {
+            body(begin, end);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(failure_mutex);
+            if (!failure) failure = std::current_exception();
+        }
+    };
+    
+    size_t chunk = (size + threads - 1) / threads;
+    workers.reserve(threads - 1);
+    try {
+        for (unsigned t = 0; t + 1 < threads; ++t) 
+            workers.emplace_back(run, t * chunk, std::min(size, (t + 1) * chunk));
+    } catch (...) {
+        // Out of threads: the started ones still reference this frame
+        for (auto& worker : workers) worker.join();
+        throw;
+    }
+    run((threads - 1) * chunk, size);
+    
+    for (auto& worker : workers) worker.join();
+    if (failure) std::rethrow_exception(failure);
+}
+} // end namespace detail
+
+// Runs a C++ callable over the items as native T values. The list is
+// converted once up front, the calls run on `threads` threads (0 = one per
+// core) with the GIL released, and the results fill a preallocated list.
+// Items that do not convert to T give an empty List; exceptions thrown by
+// the callable propagate once the GIL is held again.
+template<typename T, typename F, typename = std::enable_if_t<!std::is_base_of_v<PyObj, std::decay_t<F>>>>
+List map(F&& function, const List& list, unsigned threads = 0) {
+    using Result = std::decay_t<std::invoke_result_t<F&, const T&>>;
+    static_assert(!std::is_void_v<Result>, "map: the callable must return a value");
+    static_assert(!std::is_base_of_v<PyObj, Result>, "map: the callable runs without the GIL and cannot return Python objects");
+    static_assert(!std::is_base_of_v<PyObj, T>, "map: the callable runs without the GIL and cannot take Python objects");
+    // std::vector<bool> packs bits and cannot be written from several threads
+    using Slot = std::conditional_t<std::is_same_v<Result, bool>, unsigned char, Result>;
+    
+    PyObject* fast = list.get_obj() ? PySequence_Fast(list.get_obj(), "map: expected a sequence") : nullptr;
+    if (!fast) {
+        PyErr_Clear();
+        return List();
+    }
+    
+    size_t size = PySequence_Fast_GET_SIZE(fast);
+    PyObject** items = PySequence_Fast_ITEMS(fast);
+    std::vector<T> inputs(size);
+    for (size_t i = 0; i < size; ++i) {
+        if (!detail::Converter<T>::from(items[i], inputs[i])) {
+            Py_DECREF(fast);
+            detail::report_error();
+            return List();
+        }
+    }
+    Py_DECREF(fast);
+    
+    std::vector<Slot> results(size);
+    {
+        gil_release released;
+        detail::parallel_for(size, threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) 
+                results[i] = static_cast<Slot>(function(static_cast<const T&>(inputs[i])));
+        });
+    }
+    
+    PyObject* output = PyList_New(size);
+    if (!output) {
+        PyErr_Clear();
+        return List();
+    }
+    for (size_t i = 0; i < size; ++i) {
+        PyObject* item = detail::Converter<Result>::to(static_cast<Result>(results[i]));
+        if (!item) {
+            PyErr_Clear();
+            Py_DECREF(output);
+            return List();
+        }
+        PyList_SET_ITEM(output, i, item);
+    }
+    
+    return List(steal(output));
+}
+
+// Same, with T taken from the callable's parameter type
+template<typename F, typename = std::enable_if_t<!std::is_base_of_v<PyObj, std::decay_t<F>>>, 
+         typename T = detail::callable_argument_t<F>>
+List map(F&& function, const List& list, unsigned threads = 0) {
+    return map<T>(std::forward<F>(function), list, threads);
+}
+
+// ================== Lazy Pipelines ==================
+// pipe(seq) | map(f) | filter(g) | take(n) runs every stage on one item
+// before pulling the next, so no intermediate lists are built and take()
+// stops the source early. Nothing runs until to_list(), to_vector<T>() or
+// for_each(). Stage callables are Python callables or C++ callables taking
+// const PyObj&; a failed Python call maps to None, a failed predicate drops
+// the item. Either way the error goes through the error policy, so an
+// active ErrorBatch collects one error per failed item.
+namespace detail {
+// New reference to f(item), None once a failed call has been reported
+template<typename F>
+PyObject* call_one(F& function, PyObject* item) {
+    PyObject* result = nullptr;
+    if constexpr (std::is_base_of_v<PyObj, F>) {
+        PyObject* stack[2] = { nullptr, item };
+        result = PyObject_Vectorcall(function.get_obj(), stack + 1, 1 | PY_VECTORCALL_ARGUMENTS_OFFSET, nullptr);
+    } else {
+        using Result = std::decay_t<std::invoke_result_t<F&, const PyObj&>>;
+        result = Converter<Result>::to(function(*as_handles(&item)));
+    }
+    
+    if (!result) {
+        report_error();
+        Py_RETURN_NONE;
+    }
+    return result;
+}
+
+template<typename F>
+struct MapStage {
+    F function;
+    static constexpr bool keeps_size = true;
+    
+    void reset() {}
+    
+    template<typename Next>
+    bool process(PyObject* item, Next& next) {
+        PyObject* result = call_one(function, item);
+        bool more = next(result);
+        Py_DECREF(result);
+        return more;
+    }
+};
+
+template<typename F>
+struct FilterStage {
+    F function;
+    static constexpr bool keeps_size = false;
+    
+    void reset() {}
+    
+    template<typename Next>
+    bool process(PyObject* item, Next& next) {
+        bool keep = false;
+        if constexpr (std::is_base_of_v<PyObj, F>) {
+            PyObject* result = call_one(function, item);
+            int truth = item_truth(result);
+            Py_DECREF(result);
+            if (truth < 0) report_error();
+            keep = truth == 1;
+        } else {
+            keep = static_cast<bool>(function(*as_handles(&item)));
+        }
+        return keep ? next(item) : true;
     }
+};
 
-    // String representation
-    std::string str() const {
-        if (!obj) return "None";
-        
-        PyObject* string_obj = PyObject_Str(obj);
-        if (!string_obj) return "None";
-        
-        const char* c_str = PyUnicode_AsUTF8(string_obj);
-        std::string result = c_str ? c_str : "";
-        Py_XDECREF(string_obj);
-        
-        return result;
+struct TakeStage {
+    size_t limit;
+    size_t taken = 0;
+    static constexpr bool keeps_size = true;
+    
+    void reset() { taken = 0; }
+    
+    template<typename Next>
+    bool process(PyObject* item, Next& next) {
+        if (taken >= limit) return false;
+        ++taken;
+        return next(item) && taken < limit;
     }
 };
 
-// ================== Set Class ==================
-class Set : public PyObj {
+template<typename T>
+struct is_pipe_stage : std::false_type {};
+template<typename F>
+struct is_pipe_stage<MapStage<F>> : std::true_type {};
+template<typename F>
+struct is_pipe_stage<FilterStage<F>> : std::true_type {};
+template<>
+struct is_pipe_stage<TakeStage> : std::true_type {};
+} // end namespace detail
+
+template<typename... Stages>
+class Pipe {
 public:
-    Set() : PyObj(PySet_New(nullptr)) {}
-    explicit Set(PyObject* o) : PyObj(o) {}
+    explicit Pipe(const PyObj& source, std::tuple<Stages...> stages = {}) 
+        : source(source), stages(std::move(stages)) {}
     
-    Set(const std::initializer_list<PyObj>& elements) 
-        : PyObj(PySet_New(nullptr)) {
-        if (!obj) return;
-        
-        for (auto& value : elements)
-            PySet_Add(obj, value.get_obj());
-    }
-
-    // Set operations
-    void add(const PyObj& value) { 
-        PySet_Add(obj, value.get_obj()); 
+    template<typename Stage>
+    Pipe<Stages..., Stage> then(Stage stage) const {
+        return Pipe<Stages..., Stage>(source, std::tuple_cat(stages, std::make_tuple(std::move(stage))));
     }
     
-    void clear() { 
-        PySet_Clear(obj); 
+    // Runs the pipeline, handing each output item (borrowed) to sink until
+    // it returns false
+    template<typename Sink>
+    void for_each(Sink&& sink) {
+        std::apply([](auto&... stage) { (stage.reset(), ...); }, stages);
+        auto push = [&](PyObject* item) -> bool {
+            if constexpr (std::is_same_v<std::invoke_result_t<Sink&, const PyObj&>, void>) {
+                sink(*detail::as_handles(&item));
+                return true;
+            } else {
+                return static_cast<bool>(sink(*detail::as_handles(&item)));
+            }
+        };
+        run(push);
     }
     
-    PyObj pop() { 
-        return PyObj(PySet_Pop(obj)); 
+    // The list is allocated once at its final size when that is known up
+    // front (a list, tuple, dict or set source and no filter)
+    List to_list() {
+        std::apply([](auto&... stage) { (stage.reset(), ...); }, stages);
+        
+        Py_ssize_t bound = exact_size();
+        if (bound >= 0) {
+            List output(steal(PyList_New(bound)));
+            if (!output.get_obj()) {
+                PyErr_Clear();
+                return List();
+            }
+            
+            Py_ssize_t count = 0;
+            auto store = [&](PyObject* item) -> bool {
+                if (count >= bound) return false;
+                Py_INCREF(item);
+                PyList_SET_ITEM(output.get_obj(), count++, item);
+                return true;
+            };
+            run(store);
+            
+            // The source may shrink while stages run Python code
+            if (count < bound && PyList_SetSlice(output.get_obj(), count, bound, nullptr) < 0) {
+                PyErr_Clear();
+                return List();
+            }
+            return output;
+        }
+        
+        std::vector<PyObj> items;
+        auto collect = [&](PyObject* item) -> bool {
+            items.emplace_back(borrow(item));
+            return true;
+        };
+        run(collect);
+        
+        PyObject* output = PyList_New(items.size());
+        if (!output) {
+            PyErr_Clear();
+            return List();
+        }
+        for (size_t i = 0; i < items.size(); ++i) PyList_SET_ITEM(output, i, items[i].release());
+        return List(steal(output));
     }
-
-    // Basic properties
-    long len() const { return obj ? PySet_Size(obj) : 0; }
-    bool empty() const { return len() == 0; }
-
-    bool contains(const PyObj& value) const {
-        return obj && PySet_Contains(obj, value.get_obj()) == 1;
+    
+    // Converts the output items to T; empty if one does not convert, that
+    // item's error going through the error policy
+    template<typename T>
+    std::vector<T> to_vector() {
+        std::apply([](auto&... stage) { (stage.reset(), ...); }, stages);
+        
+        std::vector<T> output;
+        Py_ssize_t bound = exact_size();
+        if (bound >= 0) output.reserve(bound);
+        
+        bool failed = false;
+        auto convert = [&](PyObject* item) -> bool {
+            T value{};
+            if (!detail::Converter<T>::from(item, value)) {
+                failed = true;
+                detail::report_error();
+                return false;
+            }
+            output.push_back(std::move(value));
+            return true;
+        };
+        run(convert);
+        
+        if (failed) output.clear();
+        return output;
     }
 
-    // Comparison operators
-    bool operator==(const Set& other) const { 
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_EQ) == 1; 
+private:
+    template<typename... Other>
+    friend class Pipe;
+    
+    PyObj source;
+    std::tuple<Stages...> stages;
+    
+    // Output size when no stage can drop items, else -1
+    Py_ssize_t exact_size() const {
+        if (!(true && ... && Stages::keeps_size)) return -1;
+        
+        PyObject* o = source.get_obj();
+        Py_ssize_t size = -1;
+        if (!o) size = 0;
+        else if (PyList_Check(o)) size = PyList_GET_SIZE(o);
+        else if (PyTuple_Check(o)) size = PyTuple_GET_SIZE(o);
+        else if (PyDict_Check(o)) size = PyDict_GET_SIZE(o);
+        else if (PyAnySet_Check(o)) size = PySet_GET_SIZE(o);
+        if (size < 0) return -1;
+        
+        std::apply([&size](const auto&... stage) { (Pipe::clamp(size, stage), ...); }, stages);
+        return size;
     }
     
-    bool operator!=(const Set& other) const { 
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_NE) == 1; 
+    template<typename Stage>
+    static void clamp(Py_ssize_t& size, const Stage& stage) {
+        if constexpr (std::is_same_v<Stage, detail::TakeStage>) 
+            size = std::min<Py_ssize_t>(size, static_cast<Py_ssize_t>(stage.limit));
     }
     
-    bool operator<(const Set& other)  const { 
-        return issubset(other) && !issuperset(other); 
+    // A take(0) anywhere lets nothing through, so no item is even pulled
+    bool closed() const {
+        bool closed = false;
+        std::apply([&closed](const auto&... stage) { (Pipe::closes(closed, stage), ...); }, stages);
+        return closed;
     }
     
-    bool operator>(const Set& other)  const { 
-        return issuperset(other) && !issubset(other); 
+    template<typename Stage>
+    static void closes(bool& closed, const Stage& stage) {
+        if constexpr (std::is_same_v<Stage, detail::TakeStage>) 
+            closed = closed || stage.limit == 0;
     }
     
-    bool operator<=(const Set& other) const { 
-        return issubset(other); 
+    template<size_t I, typename Sink>
+    bool apply(PyObject* item, Sink& sink) {
+        if constexpr (I == sizeof...(Stages)) {
+            return sink(item);
+        } else {
+            auto next = [this, &sink](PyObject* out) { return apply<I + 1>(out, sink); };
+            return std::get<I>(stages).process(item, next);
+        }
     }
     
-    bool operator>=(const Set& other) const { 
-        return issuperset(other); 
+    // Lists and tuples are walked by index, each item held while the stages
+    // run; anything else through the iterator protocol
+    template<typename Sink>
+    void run(Sink& sink) {
+        PyObject* o = source.get_obj();
+        if (!o || closed()) return;
+        
+        // Items are held by handles, a stage may throw under ErrorPolicy::Throw
+        if (PyList_Check(o) || PyTuple_Check(o)) {
+            for (Py_ssize_t i = 0; i < PySequence_Fast_GET_SIZE(o); ++i) {
+                PyObj item(borrow(PySequence_Fast_ITEMS(o)[i]));
+                if (!apply<0>(item.get_obj(), sink)) return;
+            }
+            return;
+        }
+        
+        PyObj iterator(steal(PyObject_GetIter(o)));
+        if (!iterator.get_obj()) {
+            detail::report_error();
+            return;
+        }
+        while (PyObject* next = PyIter_Next(iterator.get_obj())) {
+            PyObj item(steal(next));
+            if (!apply<0>(item.get_obj(), sink)) return;
+        }
+        detail::report_error();
     }
+};
 
-    // Set theory operations
-    Set union_with(const Set& other) const {
-        PyObject* result = PyNumber_Or(obj, other.get_obj());
-        return Set(result ? result : PySet_New(nullptr));
-    }
+// Starts a pipeline over any iterable
+inline Pipe<> pipe(const PyObj& sequence) { return Pipe<>(sequence); }
 
-    Set intersection(const Set& other) const {
-        PyObject* result = PyNumber_And(obj, other.get_obj());
-        return Set(result ? result : PySet_New(nullptr));
-    }
+inline detail::MapStage<PyObj> map(const PyObj& function) { return { function }; }
 
-    Set difference(const Set& other) const {
-        PyObject* result = PyNumber_Subtract(obj, other.get_obj());
-        return Set(result ? result : PySet_New(nullptr));
-    }
+template<typename F, typename = std::enable_if_t<!std::is_base_of_v<PyObj, std::decay_t<F>>>>
+detail::MapStage<std::decay_t<F>> map(F&& function) { return { std::forward<F>(function) }; }
 
-    Set symmetric_difference(const Set& other) const {
-        PyObject* result = PyNumber_Xor(obj, other.get_obj());
-        return Set(result ? result : PySet_New(nullptr));
-    }
+inline detail::FilterStage<PyObj> filter(const PyObj& predicate) { return { predicate }; }
 
-    // Compound assignment operators
-    Set& operator|=(const Set& other) {
-        PyObject* result = PyObject_CallMethod(obj, "update", "O", other.get_obj());
-        Py_XDECREF(result); 
-        return *this;
-    }
+template<typename F, typename = std::enable_if_t<!std::is_base_of_v<PyObj, std::decay_t<F>>>>
+detail::FilterStage<std::decay_t<F>> filter(F&& predicate) { return { std::forward<F>(predicate) }; }
 
-    Set& operator&=(const Set& other) {
-        PyObject* intersection = PyNumber_And(obj, other.get_obj());
-        if (intersection) {
-            Py_XDECREF(obj);
-            obj = intersection;
+inline detail::TakeStage take(size_t count) { return { count }; }
+
+template<typename... Stages, typename Stage, typename = std::enable_if_t<detail::is_pipe_stage<Stage>::value>>
+Pipe<Stages..., Stage> operator|(const Pipe<Stages...>& pipeline, Stage stage) {
+    return pipeline.then(std::move(stage));
+}
+
+// ================== Compiled Code Cache ==================
+// eval() keeps code objects by source text, run_file_result() by path and
+// modification time, both per interpreter. With set_code_cache_dir() compiled
+// code is also marshalled to disk so a cold start does not compile again.
+namespace detail {
+struct CodeCache {
+    struct FileEntry {
+        std::filesystem::file_time_type mtime;
+        uintmax_t size;
+        PyObject* code;
+    };
+
+    std::mutex mutex;
+    std::unordered_map<int64_t, std::unordered_map<std::string, PyObject*>> sources;
+    std::unordered_map<int64_t, std::unordered_map<std::string, PyObject*>> expressions;
+    std::unordered_map<int64_t, std::unordered_map<std::string, FileEntry>> files;
+    std::string dir;
+    size_t limit = 1024;
+    bool hooked = false;
+};
+
+inline void drop_interpreter_code();
+
+inline CodeCache& code_cache() {
+    static CodeCache cache;
+    return cache;
+}
+
+// Callers hold cache.mutex
+inline void hook_code_cache(CodeCache& cache) {
+    if (cache.hooked) return;
+    cache.hooked = true;
+    on_interpreter_exit(drop_interpreter_code);
+}
+
+inline void drop_interpreter_code() {
+    CodeCache& cache = code_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    int64_t id = interpreter_id();
+
+    for (auto& entry : cache.sources[id]) Py_XDECREF(entry.second);
+    for (auto& entry : cache.expressions[id]) Py_XDECREF(entry.second);
+    for (auto& entry : cache.files[id]) Py_XDECREF(entry.second.code);
+    cache.sources.erase(id);
+    cache.expressions.erase(id);
+    cache.files.erase(id);
+}
+
+// FNV-1a, names the on-disk entries and guards them against stale contents
+inline uint64_t source_hash(const std::string& source, const std::string& filename, int start) {
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const std::string& text) {
+        for (unsigned char c : text) {
+            hash ^= c;
+            hash *= 1099511628211ull;
         }
-        return *this;
+    };
+    mix(filename);
+    mix(std::string(1, static_cast<char>(start)));
+    mix(source);
+    return hash;
+}
+
+struct CodeFileHeader {
+    char magic[4];
+    uint32_t python_version;
+    uint64_t hash;
+    uint64_t source_size;
+};
+
+inline std::string code_file_path(const std::string& dir, uint64_t hash) {
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.pyc", static_cast<unsigned long long>(hash));
+    return (std::filesystem::path(dir) / name).string();
+}
+
+inline PyObject* load_code_file(const std::string& path, uint64_t hash, size_t source_size) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return nullptr;
+
+    CodeFileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return nullptr;
+    if (memcmp(header.magic, "PYOC", 4) != 0 || header.python_version != PY_VERSION_HEX ||
+        header.hash != hash || header.source_size != source_size) 
+        return nullptr;
+
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    PyObject* code = PyMarshal_ReadObjectFromString(data.data(), data.size());
+    if (!code || !PyCode_Check(code)) {
+        Py_XDECREF(code);
+        PyErr_Clear();
+        return nullptr;
+    }
+    return code;
+}
+
+inline void store_code_file(const std::string& path, PyObject* code, uint64_t hash, size_t source_size) {
+    PyObject* data = PyMarshal_WriteObjectToString(code, Py_MARSHAL_VERSION);
+    if (!data) { 
+        PyErr_Clear(); 
+        return; 
     }
+
+    CodeFileHeader header = { {'P', 'Y', 'O', 'C'}, PY_VERSION_HEX, hash, source_size };
     
-    Set& operator-=(const Set& other) {
-        PyObject* difference = PyNumber_Subtract(obj, other.get_obj());
-        if (difference) {
-            Py_XDECREF(obj);
-            obj = difference;
-        }
-        return *this;
+    // Written aside and renamed so readers never see half a file
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+    std::string temp = path + ".tmp" + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    {
+        std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(PyBytes_AS_STRING(data), PyBytes_GET_SIZE(data));
     }
+    Py_DECREF(data);
     
-    Set& operator^=(const Set& other) {
-        PyObject* symmetric_diff = PyNumber_Xor(obj, other.get_obj());
-        if (symmetric_diff) {
-            Py_XDECREF(obj);
-            obj = symmetric_diff;
-        }
-        return *this;
+    std::filesystem::rename(temp, path, error);
+    if (error) std::filesystem::remove(temp, error);
+}
+
+// Returns a new reference, or nullptr with the compile error set
+inline PyObject* compile_source(const std::string& source, const std::string& filename, int start = Py_file_input) {
+    std::string dir;
+    {
+        CodeCache& cache = code_cache();
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        dir = cache.dir;
     }
+    if (dir.empty()) return Py_CompileString(source.c_str(), filename.c_str(), start);
 
-    // Binary set operators
-    Set operator|(const Set& other) const { return union_with(other); }
-    Set operator&(const Set& other) const { return intersection(other); }
-    Set operator-(const Set& other) const { return difference(other); }
-    Set operator^(const Set& other) const { return symmetric_difference(other); }
+    uint64_t hash = source_hash(source, filename, start);
+    std::string path = code_file_path(dir, hash);
 
-    // Set relations
-    bool issubset(const Set& other) const {
-        PyObject* result = PyObject_CallMethod(obj, "issubset", "O", other.get_obj());
-        bool is_subset = result && PyObject_IsTrue(result);
-        Py_XDECREF(result);
-        
-        return is_subset;
+    PyObject* code = load_code_file(path, hash, source.size());
+    if (code) return code;
+
+    code = Py_CompileString(source.c_str(), filename.c_str(), start);
+    if (code) store_code_file(path, code, hash, source.size());
+    return code;
+}
+
+inline PyObject* compile_cached(const std::string& source, int start = Py_file_input) {
+    CodeCache& cache = code_cache();
+    int64_t id = interpreter_id();
+    auto& table = start == Py_eval_input ? cache.expressions : cache.sources;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto& codes = table[id];
+        auto it = codes.find(source);
+        if (it != codes.end()) {
+            Py_INCREF(it->second);
+            return it->second;
+        }
     }
 
-    bool issuperset(const Set& other) const {
-        PyObject* result = PyObject_CallMethod(obj, "issuperset", "O", other.get_obj());
-        bool is_superset = result && PyObject_IsTrue(result);
-        Py_XDECREF(result);
-        
-        return is_superset;
+    PyObject* code = compile_source(source, "<string>", start);
+    if (!code) return nullptr;
+
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    hook_code_cache(cache);
+    auto& codes = table[id];
+    if (codes.size() >= cache.limit) {
+        for (auto& entry : codes) Py_XDECREF(entry.second);
+        codes.clear();
     }
-};
+    
+    auto inserted = codes.emplace(source, code);
+    if (inserted.second) Py_INCREF(code);
+    return code;
+}
 
-// ================== Dict Class ==================
-class Dict : public PyObj {
-public:
-    Dict() : PyObj(PyDict_New()) {}
-    explicit Dict(PyObject* o) : PyObj(o) {}
+inline bool file_stamp(const std::string& filename, std::filesystem::file_time_type& mtime, uintmax_t& size) {
+    std::error_code error;
+    mtime = std::filesystem::last_write_time(filename, error);
+    if (error) return false;
+    size = std::filesystem::file_size(filename, error);
+    return !error;
+}
+
+inline PyObject* cached_file_code(const std::string& filename, std::filesystem::file_time_type mtime, uintmax_t size) {
+    CodeCache& cache = code_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
     
-    Dict(const std::initializer_list<std::pair<PyObj, PyObj>>& elements)
-        : PyObj(PyDict_New()) {
-        if (!obj) return;
-        
-        for (auto& pair : elements)
-            PyDict_SetItem(obj, pair.first.get_obj(), pair.second.get_obj());
-    }
+    auto& codes = cache.files[interpreter_id()];
+    auto it = codes.find(filename);
+    if (it == codes.end() || it->second.mtime != mtime || it->second.size != size) return nullptr;
+    
+    Py_INCREF(it->second.code);
+    return it->second.code;
+}
 
-    // Dictionary operations
-    void add(const PyObj& key, const PyObj& value) {
-        PyDict_SetItem(obj, key.get_obj(), value.get_obj());
+inline void store_file_code(const std::string& filename, std::filesystem::file_time_type mtime, uintmax_t size, PyObject* code) {
+    CodeCache& cache = code_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    hook_code_cache(cache);
+    
+    auto& codes = cache.files[interpreter_id()];
+    auto it = codes.find(filename);
+    if (it != codes.end()) {
+        Py_XDECREF(it->second.code);
+        codes.erase(it);
     }
+    if (codes.size() >= cache.limit) {
+        for (auto& entry : codes) Py_XDECREF(entry.second.code);
+        codes.clear();
+    }
+    
+    Py_INCREF(code);
+    codes.emplace(filename, CodeCache::FileEntry{mtime, size, code});
+}
+} // end namespace detail
 
-    PyObj get(const PyObj& key) const {
-        PyObject* result = PyDict_GetItem(obj, key.get_obj());
-        Py_XINCREF(result);
-        
-        return result ? PyObj(result) : PyObj();
+// Empty dir turns the on-disk store off (the default)
+inline void set_code_cache_dir(const std::string& dir) {
+    detail::CodeCache& cache = detail::code_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.dir = dir;
+}
+
+// Most code objects kept per interpreter before the cache starts over
+inline void set_code_cache_limit(size_t limit) {
+    detail::CodeCache& cache = detail::code_cache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    cache.limit = limit ? limit : 1;
+}
+
+inline void clear_code_cache() {
+    detail::drop_interpreter_code();
+}
+
+inline PyObj run_code(PyObject* codeObj, const std::string& source_name) {
+    detail::ApiProbe<Api::RunCode> probe;
+    PyObject* globals = PyDict_New();
+    if (!globals) return PyObj();
+    
+    PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+
+    PyObject* result = PyEval_EvalCode(codeObj, globals, globals);
+
+    if (!result) {
+        Py_DECREF(globals);
+        detail::report_error();
+        return PyObj();
     }
+    Py_DECREF(result);
 
-    bool contains(const PyObj& key) const {
-        return PyDict_Contains(obj, key.get_obj()) == 1;
+    const char* system_keys[] = {
+        "__builtins__", 
+        "__name__", 
+        "__doc__",
+        "__package__", 
+        "__loader__", 
+        "__spec__", 
+        "__annotations__"
+    };
+
+    for (const char* key : system_keys) {
+        PyObject* pyKey = PyUnicode_FromString(key);
+        if (pyKey && PyDict_Contains(globals, pyKey))
+            PyDict_DelItem(globals, pyKey);
+        Py_XDECREF(pyKey);
     }
 
-    PyObj operator[](const PyObj& key) const {
-        return get(key);
+    return PyObj(steal(globals));
+}
+
+// Runs in __main__ like PyRun_SimpleString, failures go through the error policy
+inline void exec(const std::string& code) { 
+    gil_acquire gil;
+    detail::ApiProbe<Api::Exec> probe;
+    PyObject* main = PyImport_AddModule("__main__");
+    PyObject* globals = main ? PyModule_GetDict(main) : nullptr;
+    PyObject* result = globals ? PyRun_String(code.c_str(), Py_file_input, globals, globals) : nullptr;
+    
+    if (!result) {
+        detail::report_error();
+        return;
     }
+    Py_DECREF(result);
+}
 
-    // Dictionary setter helper class
-    class DictSetter {
-        PyObject* dict;
-        PyObj key;
-        
-    public:
-        DictSetter(PyObject* d, const PyObj& k) : dict(d), key(k) {}
+// eval() and run_file_result() hand back a handle, so like every other
+// PyObj they are called with the GIL held (see gil_acquire)
+inline PyObj eval(const std::string& code) {
+    detail::ApiProbe<Api::Eval> probe;
+    PyObject* codeObj = detail::compile_cached(code);
+    if (!codeObj) {
+        detail::report_error();
+        return PyObj();
+    }
+    PyObj result = run_code(codeObj, "<string>");
+    Py_DECREF(codeObj);
+    return result;
+}
 
-        void operator=(const PyObj& value) const {
-            PyDict_SetItem(dict, key.get_obj(), value.get_obj());
-        }
+// ================== Expression Evaluation ==================
+namespace detail {
+// One builtins-only globals dict per interpreter, shared by every
+// eval_expr() call that does not bring its own
+struct ExprGlobals {
+    std::mutex mutex;
+    std::unordered_map<int64_t, PyObject*> dicts;
+    bool hooked = false;
+};
 
-        operator PyObj() const {
-            PyObject* result = PyDict_GetItem(dict, key.get_obj());
-            Py_XINCREF(result);
-            
-            return result ? PyObj(result) : PyObj();
-        }
-    };
+inline ExprGlobals& expr_globals_pool() {
+    static ExprGlobals pool;
+    return pool;
+}
 
-    DictSetter operator[](const PyObj& key) {
-        return DictSetter(obj, key);
+inline void drop_expr_globals() {
+    ExprGlobals& pool = expr_globals_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    
+    auto it = pool.dicts.find(interpreter_id());
+    if (it == pool.dicts.end()) return;
+    
+    Py_XDECREF(it->second);
+    pool.dicts.erase(it);
+}
+
+// Borrowed reference
+inline PyObject* expr_globals() {
+    ExprGlobals& pool = expr_globals_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    
+    PyObject*& globals = pool.dicts[interpreter_id()];
+    if (globals) return globals;
+    
+    globals = PyDict_New();
+    if (!globals) return nullptr;
+    PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
+    
+    if (!pool.hooked) {
+        pool.hooked = true;
+        on_interpreter_exit(drop_expr_globals);
     }
+    return globals;
+}
 
-    bool set(const PyObj& key, const PyObj& value) {
-        return PyDict_SetItem(obj, key.get_obj(), value.get_obj()) == 0;
+inline PyObj eval_expr(const std::string& code, PyObject* locals, PyObject* globals) {
+    ApiProbe<Api::EvalExpr> probe;
+    if (!globals) globals = expr_globals();
+    if (!globals) {
+        detail::report_error();
+        return PyObj();
+    }
+    
+    PyObject* codeObj = compile_cached(code, Py_eval_input);
+    if (!codeObj) {
+        detail::report_error();
+        return PyObj();
     }
+    
+    PyObject* result = PyEval_EvalCode(codeObj, globals, locals ? locals : globals);
+    Py_DECREF(codeObj);
+    
+    if (!result) {
+        detail::report_error();
+        return PyObj();
+    }
+    return PyObj(steal(result));
+}
+} // end namespace detail
 
-    // Dictionary properties
-    size_t len() const { return PyDict_Size(obj); }
-    bool empty() const { return PyDict_Size(obj) == 0; }
-    void clear() { PyDict_Clear(obj); }
+// Evaluates a single expression and returns its value. Names are looked up
+// in locals, then globals; without globals a shared builtins-only dict is
+// used, so no dict is built or scrubbed per call.
+inline PyObj eval_expr(const std::string& code) {
+    return detail::eval_expr(code, nullptr, nullptr);
+}
 
-    PyObj pop(const PyObj& key) {
-        PyObject* value = PyDict_GetItem(obj, key.get_obj());
-        if (!value) return PyObj();
-        
-        Py_XINCREF(value);
-        PyDict_DelItem(obj, key.get_obj());
-        
-        return PyObj(value);
-    }
+inline PyObj eval_expr(const std::string& code, const PyObj& locals) {
+    return detail::eval_expr(code, locals.get_obj(), nullptr);
+}
 
-    // Dictionary views
-    List keys() const { return List(PyDict_Keys(obj)); }
-    List values() const { return List(PyDict_Values(obj)); }
-    List items() const { return List(PyDict_Items(obj)); }
+inline PyObj eval_expr(const std::string& code, const PyObj& locals, const PyObj& globals) {
+    return detail::eval_expr(code, locals.get_obj(), globals.get_obj());
+}
 
-    void update(const Dict& other) { 
-        PyDict_Update(obj, other.get_obj()); 
+inline void run_file(const std::string& filename) { 
+    gil_acquire gil;
+    detail::ApiProbe<Api::RunFile> probe;
+    FILE* file = fopen(filename.c_str(), "r"); 
+    if (!file) { 
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename.c_str());
+        detail::report_error();
+        return;
+    } 
+    
+    // Runs in __main__ with __file__ set for the script, like
+    // PyRun_SimpleFile, but failures go through the error policy
+    PyObject* main = PyImport_AddModule("__main__");
+    PyObject* globals = main ? PyModule_GetDict(main) : nullptr;
+    bool named = false;
+    if (globals && !PyDict_GetItemString(globals, "__file__")) {
+        PyObject* path = PyUnicode_DecodeFSDefault(filename.c_str());
+        named = path && PyDict_SetItemString(globals, "__file__", path) == 0;
+        Py_XDECREF(path);
     }
-
-    // Comparison operators
-    bool operator==(const Dict& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_EQ) == 1;
+    
+    PyObject* result = globals ? PyRun_File(file, filename.c_str(), Py_file_input, globals, globals) : nullptr;
+    fclose(file);
+    
+    if (named) {
+        PyObject *type, *value, *traceback;
+        PyErr_Fetch(&type, &value, &traceback);
+        if (PyDict_DelItemString(globals, "__file__") < 0) PyErr_Clear();
+        PyErr_Restore(type, value, traceback);
     }
-
-    bool operator!=(const Dict& other) const {
-        return PyObject_RichCompareBool(obj, other.get_obj(), Py_NE) == 1;
+    
+    if (!result) {
+        detail::report_error();
+        return;
     }
+    Py_DECREF(result);
+}
 
-    // Dictionary merging
-    Dict operator|(const Dict& other) const {
-        PyObject* merged = PyDict_Copy(obj);
-        if (!merged) return Dict();
-        
-        PyDict_Update(merged, other.get_obj());
-        return Dict(merged);
+inline PyObj run_file_result(const std::string& filename) {
+    detail::ApiProbe<Api::RunFile> probe;
+    // Unchanged files are neither read nor compiled again
+    std::filesystem::file_time_type mtime;
+    uintmax_t file_size = 0;
+    bool stamped = detail::file_stamp(filename, mtime, file_size);
+    
+    PyObject* cached = stamped ? detail::cached_file_code(filename, mtime, file_size) : nullptr;
+    if (cached) {
+        PyObj result = run_code(cached, filename);
+        Py_DECREF(cached);
+        return result;
     }
 
-    Dict& operator|=(const Dict& other) {
-        PyDict_Update(obj, other.get_obj());
-        return *this;
-    }
+    FILE* file = fopen(filename.c_str(), "r");
 
-    Dict operator+(const Dict& other) const {
-        PyObject* merged = PyDict_Copy(obj);
-        if (!merged) return Dict();
-        
-        PyDict_Update(merged, other.get_obj());
-        return Dict(merged);
+    if (!file) {
+        PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename.c_str());
+        detail::report_error();
+        return PyObj();
     }
 
-    Dict& operator+=(const Dict& other) {
-        PyDict_Update(obj, other.get_obj());
-        return *this;
-    }
-};
+    std::string code;
 
-// ================== Function Class ==================
-class Function : public PyObj {
-public:
-    Function() : PyObj() {}
-    Function(PyObject* o) : PyObj(o) {}
-    Function(const PyObj& o) : PyObj(o) {}
+    {
+        fseek(file, 0, SEEK_END);
+        long size = ftell(file);
+        rewind(file);
 
-    // ===== Universal calling method =====
-    PyObj call(const std::vector<PyObj>& args = {}, const Dict& kwargs = Dict()) const {
-        if (!obj || !PyCallable_Check(obj)) {
-            std::cerr << "Error: Object is not callable" << std::endl;
+        if (size <= 0) {
+            fclose(file);
             return PyObj();
         }
 
-        PyObject* py_args = PyTuple_New(args.size());
-        for (size_t i = 0; i < args.size(); i++) {
-            Py_XINCREF(args[i].get_obj());
-            PyTuple_SetItem(py_args, i, args[i].get_obj());
-        }
-
-        PyObject* py_kwargs = kwargs.get_obj();
-        Py_XINCREF(py_kwargs);
-
-        PyObject* result = PyObject_Call(obj, py_args, py_kwargs);
-
-        Py_DECREF(py_args);
-        Py_DECREF(py_kwargs);
+        code.resize(size);
+        size_t read = fread(&code[0], 1, size, file);
+        fclose(file);
 
-        if (!result) {
-            PyErr_Print();
+        if (read != static_cast<size_t>(size)) {
+            PyErr_SetString(PyExc_RuntimeError, "Failed to read entire file");
+            detail::report_error();
             return PyObj();
         }
+    }
 
-        return PyObj(result);
+    PyObject* codeObj = detail::compile_source(code, filename);
+    
+    if (!codeObj) {
+        detail::report_error();
+        return PyObj();
     }
+    
+    if (stamped) detail::store_file_code(filename, mtime, file_size, codeObj);
 
-    // ===== Universal Call via () =====
-    template<typename... Args>
-    PyObj operator()(Args&&... args) const {
-        std::vector<PyObj> vec;
-        Dict kwargs;
+    PyObj result = run_code(codeObj, filename);
 
-        // If the last argument is Dict, consider it kwargs
-        if constexpr (sizeof...(args) > 0) {
-            auto tuple_args = std::tuple<Args...>(std::forward<Args>(args)...);
-            if constexpr (std::is_same_v<
-                std::remove_cv_t<std::remove_reference_t<
-                    decltype(std::get<sizeof...(args)-1>(tuple_args))
-                >>,
-                Dict
-            >) {
-                kwargs = std::get<sizeof...(args)-1>(tuple_args);
-                vec = make_args_tuple(tuple_args, std::make_index_sequence<sizeof...(args)-1>{});
-            } else {
-                vec = make_args_tuple(tuple_args, std::make_index_sequence<sizeof...(args)>{});
-            }
-        }
+    Py_DECREF(codeObj);
+    return result;
+}
 
-        return call(vec, kwargs);
+// ================== JSON Functions ==================
+// Native encoder/decoder: objects are walked straight into a reused buffer
+// and parsed text is turned into objects without going through the json
+// module. Output matches json.dumps() defaults (ensure_ascii, ", " and ": "
+// separators, NaN/Infinity allowed).
+namespace detail {
+constexpr int json_max_depth = 1000;
+
+// First byte in [p, end) that a JSON string cannot hold verbatim: a quote,
+// a backslash or a control character (and DEL when escaping for ASCII output)
+inline const char* json_scan_string(const char* p, const char* end, bool escape_del) {
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    const __m128i del = _mm_set1_epi8(escape_del ? 0x7F : '"');
+    
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control), _mm_cmpeq_epi8(chunk, del)));
+        
+        int mask = _mm_movemask_epi8(special);
+        if (mask) return p + __builtin_ctz(mask);
     }
-
-    private:
-    template<typename Tuple, std::size_t... I>
-    std::vector<PyObj> make_args_tuple(const Tuple& t, std::index_sequence<I...>) const {
-        return { PyObj(std::get<I>(t))... };
+#endif
+    for (; p < end; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\' || c < 0x20 || (escape_del && c == 0x7F)) return p;
     }
-};
+    return end;
+}
 
-// ================== Formatted String ==================
-template<typename T>
-std::pair<std::string, std::string> farg(const std::string& name, T&& value) {
-    std::ostringstream os; 
-    os << value; 
-    return {name, os.str()};
+inline bool json_is_ascii(const char* p, const char* end) {
+#if defined(__SSE2__)
+    for (; end - p >= 16; p += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))) return false;
+    }
+#endif
+    for (; p < end; ++p) {
+        if (static_cast<unsigned char>(*p) & 0x80) return false;
+    }
+    return true;
 }
 
-template<typename... Args>
-std::string fstring(const std::string& format, Args&&... args) {
-    std::unordered_map<std::string, std::string> named_args;
-    std::vector<std::string> positional_args;
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out, int indent) : out(out), indent(indent) {}
     
-    auto process_arg = [&](auto&& arg) {
-        using ArgType = std::decay_t<decltype(arg)>;
+    bool write(PyObject* o, int depth = 0) {
+        if (depth > json_max_depth) {
+            PyErr_SetString(PyExc_ValueError, "json: nesting too deep (circular reference?)");
+            return false;
+        }
         
-        if constexpr (std::is_same_v<ArgType, std::pair<std::string, std::string>>) {
-            named_args.emplace(arg.first, arg.second);
-        } else {
-            std::ostringstream os; 
-            os << arg; 
-            positional_args.push_back(os.str());
+        if (o == Py_None) { out.append("null", 4); return true; }
+        if (o == Py_True) { out.append("true", 4); return true; }
+        if (o == Py_False) { out.append("false", 5); return true; }
+        if (PyUnicode_Check(o)) return write_string(o);
+        if (PyLong_Check(o)) return write_int(o);
+        if (PyFloat_Check(o)) return write_float(PyFloat_AS_DOUBLE(o));
+        if (PyList_Check(o) || PyTuple_Check(o)) return write_array(o, depth);
+        if (PyDict_Check(o)) return write_object(o, depth);
+        
+        PyErr_Format(PyExc_TypeError, "Object of type %s is not JSON serializable", Py_TYPE(o)->tp_name);
+        return false;
+    }
+
+private:
+    std::string& out;
+    int indent;
+    
+    void newline(int depth) {
+        out.push_back('\n');
+        out.append(static_cast<size_t>(indent) * depth, ' ');
+    }
+    
+    void separator(int depth) {
+        if (indent < 0) out.append(", ", 2);
+        else {
+            out.push_back(',');
+            newline(depth);
         }
-    };
+    }
     
-    (process_arg(std::forward<Args>(args)), ...);
+    bool write_int(PyObject* o) {
+        int overflow = 0;
+        long long value = PyLong_AsLongLongAndOverflow(o, &overflow);
+        if (!overflow) {
+            if (value == -1 && PyErr_Occurred()) return false;
+            char digits[24];
+            int n = std::snprintf(digits, sizeof(digits), "%lld", value);
+            out.append(digits, n);
+            return true;
+        }
+        
+        // int.__repr__ also covers subclasses such as IntEnum
+        PyObject* text = PyLong_Type.tp_repr(o);
+        if (!text) return false;
+        std::string_view view = unicode_view(text);
+        out.append(view.data(), view.size());
+        Py_DECREF(text);
+        return true;
+    }
     
-    std::string output;
-    output.reserve(format.size() + 32);
-    size_t position_index = 0;
+    bool write_float(double value) {
+        if (value != value) { out.append("NaN", 3); return true; }
+        if (value == std::numeric_limits<double>::infinity()) { out.append("Infinity", 8); return true; }
+        if (value == -std::numeric_limits<double>::infinity()) { out.append("-Infinity", 9); return true; }
+        
+        char* text = PyOS_double_to_string(value, 'r', 0, Py_DTSF_ADD_DOT_0, nullptr);
+        if (!text) return false;
+        out.append(text);
+        PyMem_Free(text);
+        return true;
+    }
     
-    for (size_t i = 0; i < format.size(); ++i) {
-        if (format[i] == '{') {
-            // Handle escaped braces
-            if (i + 1 < format.size() && format[i + 1] == '{') {
-                output.push_back('{');
-                ++i;
-                continue;
-            }
+    void write_escape(Py_UCS4 c) {
+        switch (c) {
+            case '"': out.append("\\\"", 2); return;
+            case '\\': out.append("\\\\", 2); return;
+            case '\n': out.append("\\n", 2); return;
+            case '\r': out.append("\\r", 2); return;
+            case '\t': out.append("\\t", 2); return;
+            case '\b': out.append("\\b", 2); return;
+            case '\f': out.append("\\f", 2); return;
+        }
+        
+        if (c >= 0x10000) {
+            c -= 0x10000;
+            write_escape(0xD800 | (c >> 10));
+            write_escape(0xDC00 | (c & 0x3FF));
+            return;
+        }
+        
+        static const char hex[] = "0123456789abcdef";
+        char code[6] = {'\\', 'u', hex[(c >> 12) & 0xF], hex[(c >> 8) & 0xF], hex[(c >> 4) & 0xF], hex[c & 0xF]};
+        out.append(code, 6);
+    }
+    
+    bool write_string(PyObject* o) {
+        out.push_back('"');
+        
+        if (PyUnicode_IS_ASCII(o)) {
+            const char* p = static_cast<const char*>(PyUnicode_DATA(o));
+            const char* end = p + PyUnicode_GET_LENGTH(o);
             
-            // Find closing brace
-            size_t j = format.find('}', i + 1);
-            if (j == std::string::npos) {
-                output.push_back('{');
-                continue;
+            while (p < end) {
+                const char* special = json_scan_string(p, end, true);
+                out.append(p, special - p);
+                if (special == end) break;
+                write_escape(static_cast<unsigned char>(*special));
+                p = special + 1;
             }
+        } else {
+            int kind = PyUnicode_KIND(o);
+            const void* data = PyUnicode_DATA(o);
+            Py_ssize_t size = PyUnicode_GET_LENGTH(o);
             
-            std::string key = format.substr(i + 1, j - i - 1);
-            
-            // Handle empty key (positional) or named key
-            if (key.empty()) {
-                if (position_index < positional_args.size()) {
-                    output += positional_args[position_index++];
-                } else {
-                    output += "{}";
-                }
-            } else {
-                auto it = named_args.find(key);
-                if (it != named_args.end()) {
-                    output += it->second;
-                } else {
-                    output += "{" + key + "}";
-                }
+            for (Py_ssize_t i = 0; i < size; ++i) {
+                Py_UCS4 c = PyUnicode_READ(kind, data, i);
+                if (c >= 0x20 && c < 0x7F && c != '"' && c != '\\') out.push_back(static_cast<char>(c));
+                else write_escape(c);
             }
+        }
+        
+        out.push_back('"');
+        return true;
+    }
+    
+    bool write_array(PyObject* o, int depth) {
+        bool is_list = PyList_Check(o);
+        Py_ssize_t size = is_list ? PyList_GET_SIZE(o) : PyTuple_GET_SIZE(o);
+        if (size == 0) { out.append("[]", 2); return true; }
+        
+        out.push_back('[');
+        if (indent >= 0) newline(depth + 1);
+        
+        for (Py_ssize_t i = 0; i < size; ++i) {
+            if (i) separator(depth + 1);
+            if (!write(is_list ? PyList_GET_ITEM(o, i) : PyTuple_GET_ITEM(o, i), depth + 1)) return false;
+        }
+        
+        if (indent >= 0) newline(depth);
+        out.push_back(']');
+        return true;
+    }
+    
+    // json.dumps() turns None/bool/int/float keys into their JSON text
+    bool write_key(PyObject* key) {
+        if (PyUnicode_Check(key)) return write_string(key);
+        
+        out.push_back('"');
+        bool written = false;
+        if (key == Py_None || key == Py_True || key == Py_False || PyLong_Check(key)) written = write(key);
+        else if (PyFloat_Check(key)) written = write_float(PyFloat_AS_DOUBLE(key));
+        else PyErr_Format(PyExc_TypeError, "keys must be str, int, float, bool or None, not %s", Py_TYPE(key)->tp_name);
+        out.push_back('"');
+        return written;
+    }
+    
+    bool write_object(PyObject* o, int depth) {
+        if (PyDict_GET_SIZE(o) == 0) { out.append("{}", 2); return true; }
+        
+        out.push_back('{');
+        if (indent >= 0) newline(depth + 1);
+        
+        Py_ssize_t pos = 0;
+        PyObject *key, *value;
+        bool first = true;
+        while (PyDict_Next(o, &pos, &key, &value)) {
+            if (!first) separator(depth + 1);
+            first = false;
             
-            i = j;
-        } else if (format[i] == '}') {
-            // Handle escaped braces
-            if (i + 1 < format.size() && format[i + 1] == '}') {
-                output.push_back('}');
-                ++i;
-            } else {
-                output.push_back('}');
-            }
-        } else {
-            output.push_back(format[i]);
+            if (!write_key(key)) return false;
+            out.append(": ", 2);
+            if (!write(value, depth + 1)) return false;
         }
+        
+        if (indent >= 0) newline(depth);
+        out.push_back('}');
+        return true;
     }
+};
+
+// Encodes into a per-thread buffer that keeps its capacity between calls
+inline const std::string* json_encode(PyObject* o, int indent) {
+    thread_local std::string buffer;
+    buffer.clear();
     
-    return output;
+    JsonWriter writer(buffer, indent);
+    return o && writer.write(o) ? &buffer : nullptr;
 }
 
-// ================== Pretty Print Implementation ==================
-namespace detail {
-inline void pretty_print(std::ostream& os, const PyObj& obj, int indent = 0) {
-    if (!obj.get_obj()) { 
-        os << "None"; 
-        return; 
+class JsonParser {
+public:
+    JsonParser(const char* data, size_t size) : begin(data), p(data), end(data + size) {}
+    
+    ~JsonParser() { 
+        Py_XDECREF(memo);
+        for (PyObject* item : items) Py_DECREF(item);
     }
     
-    PyObject* object = obj.get_obj();
+    // Parses one complete document; trailing non-whitespace is an error
+    PyObject* parse_document() {
+        PyObject* result = parse_value(0);
+        if (!result) return nullptr;
+        
+        skip_whitespace();
+        if (p != end) {
+            Py_DECREF(result);
+            return fail("Extra data");
+        }
+        return result;
+    }
     
-    // Handle basic types
-    if (PyBool_Check(object)) { 
-        os << (object == Py_True ? "True" : "False"); 
-        return; 
+    PyObject* parse_value(int depth) {
+        skip_whitespace();
+        if (p == end) return fail("Expecting value");
+        
+        switch (*p) {
+            case '{': return parse_object(depth);
+            case '[': return parse_array(depth);
+            case '"': return parse_string();
+            case 't': return literal("true", Py_True);
+            case 'f': return literal("false", Py_False);
+            case 'n': return literal("null", Py_None);
+            case 'N': return constant("NaN", std::numeric_limits<double>::quiet_NaN());
+            case 'I': return constant("Infinity", std::numeric_limits<double>::infinity());
+            default: return parse_number();
+        }
     }
     
-    if (PyLong_Check(object)) { 
-        os << PyLong_AsLong(object); 
-        return; 
+    void skip_whitespace() {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
     }
     
-    if (PyFloat_Check(object)) { 
-        os << PyFloat_AsDouble(object); 
-        return; 
+    // Cursor access for callers that read a document piece by piece
+    bool at_end() const { return p == end; }
+    bool consume(char c) {
+        if (p == end || *p != c) return false;
+        ++p;
+        return true;
+    }
+    size_t offset() const { return p - begin; }
+    PyObject* error(const char* message) { return fail(message); }
+    
+    // Keys are only shared within one element of a stream
+    void reset_memo() { Py_CLEAR(memo); }
+
+private:
+    const char* begin;
+    const char* p;
+    const char* end;
+    PyObject* memo = nullptr;  // repeated object keys share one str, like json.loads
+    std::string scratch;       // reused for strings with escapes
+    std::vector<PyObject*> items;  // array items of every open level, so lists are sized once
+    
+    PyObject* fail(const char* message) {
+        if (!PyErr_Occurred())
+            PyErr_Format(PyExc_ValueError, "%s: char %zd", message, static_cast<Py_ssize_t>(p - begin));
+        return nullptr;
     }
     
-    if (PyUnicode_Check(object)) { 
-        const char* str = PyUnicode_AsUTF8(object); 
-        os << "\"" << (str ? str : "") << "\""; 
-        return; 
+    bool match(const char* word) {
+        size_t size = std::strlen(word);
+        if (static_cast<size_t>(end - p) < size || std::memcmp(p, word, size) != 0) return false;
+        p += size;
+        return true;
     }
-
-    // Handle lists
-    if (PyList_Check(object)) {
-        Py_ssize_t size = PyList_Size(object); 
-        if (size == 0) {
-            os << "[]"; 
-            return;
+    
+    PyObject* literal(const char* word, PyObject* value) {
+        if (!match(word)) return fail("Expecting value");
+        Py_INCREF(value);
+        return value;
+    }
+    
+    PyObject* constant(const char* word, double value) {
+        if (!match(word)) return fail("Expecting value");
+        return PyFloat_FromDouble(value);
+    }
+    
+    PyObject* parse_number() {
+        const char* start = p;
+        if (p < end && *p == '-') {
+            ++p;
+            if (match("Infinity")) return PyFloat_FromDouble(-std::numeric_limits<double>::infinity());
+        }
+        
+        const char* digits = p;
+        while (p < end && *p >= '0' && *p <= '9') ++p;
+        if (p == digits || (*digits == '0' && p - digits > 1)) {
+            p = start;
+            return fail("Expecting value");
         }
         
-        os << "[\n"; 
-        for (Py_ssize_t i = 0; i < size; ++i) { 
-            for (int j = 0; j < indent + 4; ++j) os << ' '; 
+        bool is_float = false;
+        if (p < end && *p == '.') {
+            const char* fraction = ++p;
+            while (p < end && *p >= '0' && *p <= '9') ++p;
+            if (p == fraction) return fail("Expecting digits after '.'");
+            is_float = true;
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            ++p;
+            if (p < end && (*p == '+' || *p == '-')) ++p;
+            const char* exponent = p;
+            while (p < end && *p >= '0' && *p <= '9') ++p;
+            if (p == exponent) return fail("Expecting exponent digits");
+            is_float = true;
+        }
+        
+        size_t size = p - start;
+        if (!is_float && p - digits <= 18) {
+            long long value = 0;
+            for (const char* d = digits; d < p; ++d) value = value * 10 + (*d - '0');
+            return PyLong_FromLongLong(*start == '-' ? -value : value);
+        }
+        
+        // The input is not NUL-terminated in general (mmap, slices)
+        scratch.assign(start, size);
+        if (!is_float) return PyLong_FromString(scratch.c_str(), nullptr, 10);
+        
+        double value = PyOS_string_to_double(scratch.c_str(), nullptr, nullptr);
+        if (value == -1.0 && PyErr_Occurred()) return nullptr;
+        return PyFloat_FromDouble(value);
+    }
+    
+    static int hex_value(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+    
+    bool read_hex4(unsigned& code) {
+        if (end - p < 4) return false;
+        code = 0;
+        for (int i = 0; i < 4; ++i) {
+            int digit = hex_value(p[i]);
+            if (digit < 0) return false;
+            code = code << 4 | digit;
+        }
+        p += 4;
+        return true;
+    }
+    
+    void append_utf8(unsigned code) {
+        if (code < 0x80) scratch.push_back(static_cast<char>(code));
+        else if (code < 0x800) {
+            scratch.push_back(static_cast<char>(0xC0 | code >> 6));
+            scratch.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            scratch.push_back(static_cast<char>(0xE0 | code >> 12));
+            scratch.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            scratch.push_back(static_cast<char>(0xF0 | code >> 18));
+            scratch.push_back(static_cast<char>(0x80 | (code >> 12 & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | (code >> 6 & 0x3F)));
+            scratch.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+    
+    PyObject* parse_string() {
+        const char* start = ++p;
+        const char* special = json_scan_string(p, end, false);
+        
+        // Common case: no escapes, build the str from the run in place
+        if (special < end && *special == '"') {
+            p = special + 1;
+            if (!json_is_ascii(start, special)) return PyUnicode_DecodeUTF8(start, special - start, nullptr);
+            
+            PyObject* text = PyUnicode_New(special - start, 127);
+            if (text) std::memcpy(PyUnicode_DATA(text), start, special - start);
+            return text;
+        }
+        
+        scratch.clear();
+        while (true) {
+            special = json_scan_string(p, end, false);
+            scratch.append(p, special - p);
+            p = special;
             
-            PyObject* item = PyList_GetItem(object, i); 
-            Py_XINCREF(item); 
-            pretty_print(os, PyObj(item), indent + 4); 
-            Py_XDECREF(item); 
+            if (p == end) return fail("Unterminated string starting at");
+            if (*p == '"') break;
+            if (*p != '\\') return fail("Invalid control character at");
             
-            if (i != size - 1) os << ","; 
-            os << "\n"; 
-        } 
+            if (++p == end) return fail("Unterminated string starting at");
+            char c = *p++;
+            switch (c) {
+                case '"': scratch.push_back('"'); break;
+                case '\\': scratch.push_back('\\'); break;
+                case '/': scratch.push_back('/'); break;
+                case 'b': scratch.push_back('\b'); break;
+                case 'f': scratch.push_back('\f'); break;
+                case 'n': scratch.push_back('\n'); break;
+                case 'r': scratch.push_back('\r'); break;
+                case 't': scratch.push_back('\t'); break;
+                case 'u': {
+                    unsigned code;
+                    if (!read_hex4(code)) return fail("Invalid \\uXXXX escape");
+                    
+                    unsigned low;
+                    if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                        const char* mark = p;
+                        p += 2;
+                        if (read_hex4(low) && low >= 0xDC00 && low < 0xE000) 
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        else 
+                            p = mark;
+                    }
+                    append_utf8(code);
+                    break;
+                }
+                default:
+                    --p;
+                    return fail("Invalid \\escape");
+            }
+        }
         
-        for (int j = 0; j < indent; ++j) os << ' '; 
-        os << "]"; 
-        return;
+        ++p;
+        // Lone surrogates are legal in JSON text and in Python str
+        return PyUnicode_DecodeUTF8(scratch.data(), scratch.size(), "surrogatepass");
     }
     
-    // Handle tuples
-    if (PyTuple_Check(object)) { 
-        Py_ssize_t size = PyTuple_Size(object); 
-        if (size == 0) {
-            os << "()"; 
-            return;
+    PyObject* parse_key() {
+        PyObject* key = parse_string();
+        if (!key) return nullptr;
+        
+        if (!memo && !(memo = PyDict_New())) {
+            Py_DECREF(key);
+            return nullptr;
+        }
+        
+        PyObject* shared = PyDict_SetDefault(memo, key, key);
+        Py_XINCREF(shared);
+        Py_DECREF(key);
+        return shared;
+    }
+    
+    PyObject* parse_array(int depth) {
+        if (depth >= json_max_depth) return fail("Nesting too deep");
+        ++p;
+        
+        size_t base = items.size();
+        skip_whitespace();
+        if (p < end && *p == ']') {
+            ++p;
+            return PyList_New(0);
         }
         
-        os << "(\n"; 
-        for (Py_ssize_t i = 0; i < size; ++i) { 
-            for (int j = 0; j < indent + 4; ++j) os << ' '; 
+        while (true) {
+            PyObject* item = parse_value(depth + 1);
+            if (!item) return nullptr;
+            items.push_back(item);
             
-            PyObject* item = PyTuple_GetItem(object, i); 
-            Py_XINCREF(item); 
-            pretty_print(os, PyObj(item), indent + 4); 
-            Py_XDECREF(item); 
+            skip_whitespace();
+            if (p < end && *p == ',') { ++p; continue; }
+            if (p < end && *p == ']') { ++p; break; }
             
-            if (i != size - 1) os << ","; 
-            os << "\n"; 
-        } 
+            return fail("Expecting ',' delimiter");
+        }
         
-        for (int j = 0; j < indent; ++j) os << ' '; 
-        os << ")"; 
-        return;
+        PyObject* list = PyList_New(items.size() - base);
+        if (!list) return nullptr;
+        
+        // The list takes over the references
+        for (size_t i = base; i < items.size(); ++i) PyList_SET_ITEM(list, i - base, items[i]);
+        items.resize(base);
+        return list;
     }
     
-    // Handle dictionaries
-    if (PyDict_Check(object)) { 
-        Py_ssize_t pos = 0; 
-        PyObject *key, *value; 
+    PyObject* parse_object(int depth) {
+        if (depth >= json_max_depth) return fail("Nesting too deep");
+        ++p;
         
-        if (PyDict_Size(object) == 0) {
-            os << "{}"; 
-            return;
-        }
+        PyObject* dict = PyDict_New();
+        if (!dict) return nullptr;
         
-        os << "{\n"; 
-        bool first = true; 
+        skip_whitespace();
+        if (p < end && *p == '}') {
+            ++p;
+            return dict;
+        }
         
-        while (PyDict_Next(object, &pos, &key, &value)) { 
-            if (!first) os << ",\n"; 
-            first = false; 
+        while (true) {
+            skip_whitespace();
+            if (p == end || *p != '"') {
+                Py_DECREF(dict);
+                return fail("Expecting property name enclosed in double quotes");
+            }
+            
+            PyObject* key = parse_key();
+            if (!key) {
+                Py_DECREF(dict);
+                return nullptr;
+            }
             
-            for (int j = 0; j < indent + 4; ++j) os << ' '; 
+            skip_whitespace();
+            if (p == end || *p != ':') {
+                Py_DECREF(key);
+                Py_DECREF(dict);
+                return fail("Expecting ':' delimiter");
+            }
+            ++p;
             
-            Py_XINCREF(key); 
-            pretty_print(os, PyObj(key), indent + 4); 
-            Py_XDECREF(key); 
+            PyObject* value = parse_value(depth + 1);
+            bool stored = value && PyDict_SetItem(dict, key, value) == 0;
+            Py_DECREF(key);
+            Py_XDECREF(value);
+            if (!stored) {
+                Py_DECREF(dict);
+                return nullptr;
+            }
             
-            os << ": "; 
+            skip_whitespace();
+            if (p < end && *p == ',') { ++p; continue; }
+            if (p < end && *p == '}') { ++p; return dict; }
             
-            Py_XINCREF(value); 
-            pretty_print(os, PyObj(value), indent + 4); 
-            Py_XDECREF(value); 
-        } 
-        
-        os << "\n"; 
-        for (int j = 0; j < indent; ++j) os << ' '; 
-        os << "}"; 
-        return;
+            Py_DECREF(dict);
+            return fail("Expecting ',' delimiter");
+        }
     }
-    
-    // Handle sets
-    if (PySet_Check(object)) { 
-        PyObject* iterator = PyObject_GetIter(object); 
-        if (!iterator) { 
-            os << "<set>"; 
-            return;
-        } 
+};
+
+inline PyObj json_decode(const char* data, size_t size) {
+    JsonParser parser(data, size);
+    PyObject* result = parser.parse_document();
+    if (!result) PyErr_Clear();
+    return PyObj(steal(result));
+}
+
+// Read-only mapping of a whole file; pages are only loaded as they are read
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename) {
+#ifdef _WIN32
+        file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, 
+                           OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
         
-        PyObject* item;
-        bool first = true; 
-        os << "{\n"; 
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size)) return;
+        length = static_cast<size_t>(file_size.QuadPart);
+        opened = true;
+        if (length == 0) return;
         
-        while ((item = PyIter_Next(iterator))) { 
-            if (!first) os << ",\n"; 
-            first = false; 
-            
-            for (int j = 0; j < indent + 4; ++j) os << ' '; 
-            pretty_print(os, PyObj(item), indent + 4); 
-            Py_XDECREF(item);
-        } 
-        
-        Py_XDECREF(iterator); 
-        os << "\n"; 
-        for (int j = 0; j < indent; ++j) os << ' '; 
-        os << "}"; 
-        return;
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) { opened = false; return; }
+        
+        bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        opened = bytes != nullptr;
+#else
+        fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        
+        struct stat info;
+        if (fstat(fd, &info) != 0) return;
+        length = static_cast<size_t>(info.st_size);
+        opened = true;
+        if (length == 0) return;
+        
+        void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) { opened = false; return; }
+        
+        bytes = static_cast<const char*>(address);
+        madvise(address, length, MADV_SEQUENTIAL);
+#endif
     }
     
-    // Fallback: use repr
-    PyObject* repr = PyObject_Repr(object); 
-    if (repr) { 
-        const char* str = PyUnicode_AsUTF8(repr); 
-        os << (str ? str : "<repr-error>"); 
-        Py_XDECREF(repr); 
-    } else { 
-        PyErr_Clear(); 
-        os << "<PyObj>"; 
+    ~MappedFile() {
+#ifdef _WIN32
+        if (bytes) UnmapViewOfFile(bytes);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#else
+        if (bytes) munmap(const_cast<char*>(bytes), length);
+        if (fd >= 0) ::close(fd);
+#endif
     }
-}
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    bool valid() const { return opened; }
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+    
+    // Hands the pages below offset back to the OS so a long scan keeps a flat RSS
+    void release_before(size_t offset) {
+#ifndef _WIN32
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t end = offset / page * page;
+        if (bytes && end > released) {
+            madvise(const_cast<char*>(bytes) + released, end - released, MADV_DONTNEED);
+            released = end;
+        }
+#endif
+    }
+
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+    bool opened = false;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+#else
+    int fd = -1;
+    size_t released = 0;
+#endif
+};
 
+inline size_t json_bom_size(const char* data, size_t size) {
+    return size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0 ? 3 : 0;
+}
 } // end namespace detail
 
-// ================== Output Operators ==================
-inline std::ostream& operator<<(std::ostream& os, const PyObj& obj) {
-    if (!obj.get_obj()) { 
-        os << "None"; 
-        return os; 
+inline bool json_dump(const PyObj& obj, const Str& filename, int indent = -1) {
+    detail::ApiProbe<Api::JsonDump> probe;
+    const std::string* text = detail::json_encode(obj.get_obj(), indent);
+    if (!text) {
+        PyErr_Clear();
+        return false;
     }
     
-    PyObject* repr = PyObject_Repr(obj.get_obj());
-    if (repr) { 
-        os << PyUnicode_AsUTF8(repr); 
-        Py_XDECREF(repr); 
-    } else { 
-        PyErr_Clear(); 
-        os << "<PyObj>"; 
+    std::ofstream file(filename.str(), std::ios::binary | std::ios::trunc);
+    file.write(text->data(), text->size());
+    return static_cast<bool>(file);
+}
+
+inline Str json_dumps(const PyObj& obj, int indent = -1) {
+    detail::ApiProbe<Api::JsonDumps> probe;
+    const std::string* text = detail::json_encode(obj.get_obj(), indent);
+    if (!text) {
+        PyErr_Clear();
+        return Str();
     }
     
-    return os;
+    // Output is always ASCII, so the str is filled with a single copy
+    PyObject* result = PyUnicode_New(text->size(), 127);
+    if (!result) {
+        PyErr_Clear();
+        return Str();
+    }
+    std::memcpy(PyUnicode_DATA(result), text->data(), text->size());
+    
+    return Str(steal(result));
 }
 
-// ================== Global Functions ==================
-inline Str type(const PyObj& obj) { 
-    if (!obj.get_obj()) return Str("<NoneType>"); 
+inline PyObj json_load(const Str& filename) {
+    detail::ApiProbe<Api::JsonLoad> probe;
+    std::ifstream file(filename.str(), std::ios::binary);
+    if (!file) return PyObj();
     
-    PyObject* type_obj = PyObject_Type(obj.get_obj()); 
-    if (!type_obj) return Str("<unknown>"); 
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
     
-    PyObject* name = PyObject_GetAttrString(type_obj, "__name__"); 
-    Py_XDECREF(type_obj); 
+    size_t offset = detail::json_bom_size(text.data(), text.size());
+    return detail::json_decode(text.data() + offset, text.size() - offset);
+}
+
+// Parses straight from a memory mapping, without a read buffer or file object
+inline PyObj json_load_mmap(const Str& filename) {
+    detail::ApiProbe<Api::JsonLoad> probe;
+    detail::MappedFile file(filename.str());
+    if (!file.valid()) return PyObj();
     
-    if (!name) return Str("<unknown>"); 
+    size_t offset = detail::json_bom_size(file.data(), file.size());
+    return detail::json_decode(file.data() + offset, file.size() - offset);
+}
+
+namespace detail {
+// True when the array at p closes on its own line and more values follow,
+// i.e. p starts an NDJSON file whose rows are arrays. A top-level array
+// either spans lines or is the only value in the file.
+inline bool json_array_row(const char* p, const char* end) {
+    if (p == end || *p != '[') return false;
     
-    const char* type_name = PyUnicode_AsUTF8(name); 
-    Str result(type_name ? type_name : "<unknown>"); 
-    Py_XDECREF(name); 
+    int depth = 0;
+    for (; p < end; ++p) {
+        char c = *p;
+        if (c == '"') {
+            for (++p; p < end && *p != '"'; ++p) 
+                if (*p == '\\') ++p;
+        } else if (c == '[' || c == '{') {
+            ++depth;
+        } else if (c == ']' || c == '}') {
+            if (--depth == 0) break;
+        } else if (c == '\n') {
+            return false;
+        }
+    }
+    if (p >= end) return false;
     
-    return result; 
+    for (++p; p < end; ++p)
+        if (*p != ' ' && *p != '\n' && *p != '\r' && *p != '\t') return true;
+    return false;
 }
+} // end namespace detail
 
-inline long len(const PyObj& obj) {
-    if (!obj.get_obj()) return 0;
+// Yields the top-level elements of a memory-mapped file one at a time: the
+// items of a top-level array, or each value of an NDJSON file (whose rows
+// may themselves be arrays). Only the
+// current element is kept in memory. Iteration stops at the first syntax
+// error, which error() then describes.
+class JsonStream {
+public:
+    class iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = PyObj;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const PyObj*;
+        using reference = const PyObj&;
+        
+        iterator() = default;
+        explicit iterator(JsonStream* stream) : stream(stream) { ++*this; }
+        
+        reference operator*() const { return current; }
+        pointer operator->() const { return &current; }
+        
+        iterator& operator++() {
+            if (stream && !stream->next(current)) stream = nullptr;
+            return *this;
+        }
+        
+        bool operator==(const iterator& other) const { return stream == other.stream; }
+        bool operator!=(const iterator& other) const { return stream != other.stream; }
     
-    if (obj.is_str()) return PyUnicode_GetLength(obj.get_obj());
-    if (obj.is_list()) return PyList_Size(obj.get_obj());
-    if (obj.is_tuple()) return PyTuple_Size(obj.get_obj());
-    if (obj.is_set()) return PySet_Size(obj.get_obj());
-    if (obj.is_dict()) return PyDict_Size(obj.get_obj());
+    private:
+        JsonStream* stream = nullptr;
+        PyObj current;
+    };
+    
+    explicit JsonStream(const std::string& filename) 
+        : file(filename), 
+          parser(file.data() + detail::json_bom_size(file.data(), file.size()), 
+                 file.size() - detail::json_bom_size(file.data(), file.size())) {
+        if (!file.valid()) {
+            message = "cannot open " + filename;
+            return;
+        }
+        
+        parser.skip_whitespace();
+        const char* start = file.data() + detail::json_bom_size(file.data(), file.size());
+        const char* stop = file.data() + file.size();
+        array = !detail::json_array_row(start + parser.offset(), stop) && parser.consume('[');
+        if (array) {
+            parser.skip_whitespace();
+            finished = parser.consume(']');
+        }
+    }
+    
+    JsonStream(const JsonStream&) = delete;
+    JsonStream& operator=(const JsonStream&) = delete;
+    
+    iterator begin() { return iterator(this); }
+    iterator end() { return iterator(); }
+    
+    bool failed() const { return !message.empty(); }
+    const std::string& error() const { return message; }
+
+private:
+    detail::MappedFile file;
+    detail::JsonParser parser;
+    bool array = false;
+    bool finished = false;
+    bool first = true;
+    std::string message;
+    
+    bool next(PyObj& out) {
+        if (finished || failed()) return false;
+        
+        if (array) {
+            if (!first) {
+                parser.skip_whitespace();
+                if (parser.consume(']')) return finish();
+                if (!parser.consume(',')) return fail(parser.error("Expecting ',' delimiter"));
+            }
+        } else {
+            parser.skip_whitespace();
+            if (parser.at_end()) return finish();
+        }
+        first = false;
+        
+        PyObject* element = parser.parse_value(0);
+        parser.reset_memo();
+        if (!element) return fail(nullptr);
+        
+        out = PyObj(steal(element));
+        file.release_before(parser.offset());
+        return true;
+    }
+    
+    bool finish() {
+        finished = true;
+        parser.skip_whitespace();
+        if (array && !parser.at_end()) fail(parser.error("Extra data"));
+        return false;
+    }
+    
+    bool fail(PyObject*) {
+        finished = true;
+        message = "json_stream: parse error";
+        
+        PyObject *type, *value, *traceback;
+        PyErr_Fetch(&type, &value, &traceback);
+        if (value) {
+            Str text(steal(PyObject_Str(value)));
+            if (text.get_obj()) message = text.str();
+        }
+        Py_XDECREF(type);
+        Py_XDECREF(value);
+        Py_XDECREF(traceback);
+        PyErr_Clear();
+        return false;
+    }
+};
+
+inline JsonStream json_stream(const Str& filename) {
+    return JsonStream(filename.str());
+}
+
+inline PyObj json_loads(const Str& json_string) {
+    detail::ApiProbe<Api::JsonLoads> probe;
+    PyObject* source = json_string.get_obj();
+    if (!source) return PyObj();
+    
+    if (PyBytes_Check(source)) 
+        return detail::json_decode(PyBytes_AS_STRING(source), PyBytes_GET_SIZE(source));
+    
+    std::string_view text = detail::unicode_view(source);
+    if (!text.data()) {
+        PyErr_Clear();
+        return PyObj();
+    }
+    return detail::json_decode(text.data(), text.size());
+}
+
+
+// ================== Columnar Table ==================
+// Rows held as one contiguous array per column instead of a List of Dicts:
+// ints as int64, floats as double, bools as bytes, text in one UTF-8 arena
+// with offsets, anything else (mixed types, nested containers) as objects.
+// Missing fields and None are nulls. Kernels on native columns (where,
+// filter, map, sum) touch no Python objects and can run under gil_release;
+// object columns, like every PyObj, need the GIL.
+class Table {
+public:
+    enum class Type { Int, Float, Bool, String, Object };
+    
+    class Column {
+    public:
+        Column() = default;
+        Column(std::string name, Type type, size_t rows) : column_name(std::move(name)), column_type(type) { 
+            resize(rows); 
+        }
+        
+        const std::string& name() const { return column_name; }
+        Type type() const { return column_type; }
+        size_t size() const { return nulls.size(); }
+        
+        bool is_null(size_t row) const { return !nulls[row]; }
+        
+        // Typed storage; null rows hold 0 / empty text
+        const std::vector<int64_t>& ints() const { return int_values; }
+        const std::vector<double>& floats() const { return float_values; }
+        const std::vector<uint8_t>& bools() const { return bool_values; }
+        const std::vector<PyObj>& objects() const { return object_values; }
+        const std::string& text() const { return text_values; }
+        const std::vector<uint64_t>& offsets() const { return text_offsets; }
+        
+        std::string_view string(size_t row) const {
+            return std::string_view(text_values).substr(text_offsets[row], text_offsets[row + 1] - text_offsets[row]);
+        }
+        
+        // Native value of a row for T = int64_t, double, bool or std::string_view
+        template<typename T>
+        T get(size_t row) const {
+            if constexpr (std::is_same_v<T, std::string_view>) return string(row);
+            else if constexpr (std::is_same_v<T, bool>) return bool_values[row] != 0;
+            else if constexpr (std::is_floating_point_v<T>) 
+                return column_type == Type::Float ? static_cast<T>(float_values[row]) : static_cast<T>(int_values[row]);
+            else return static_cast<T>(int_values[row]);
+        }
+        
+        template<typename T>
+        bool holds() const {
+            if constexpr (std::is_same_v<T, std::string_view>) return column_type == Type::String;
+            else if constexpr (std::is_same_v<T, bool>) return column_type == Type::Bool;
+            else if constexpr (std::is_floating_point_v<T>) return column_type == Type::Float || column_type == Type::Int;
+            else if constexpr (std::is_integral_v<T>) return column_type == Type::Int;
+            else return false;
+        }
+        
+        // New reference to the row as a Python object, None for a null
+        PyObject* to_python(size_t row) const {
+            if (is_null(row)) Py_RETURN_NONE;
+            
+            switch (column_type) {
+                case Type::Int: return PyLong_FromLongLong(int_values[row]);
+                case Type::Float: return PyFloat_FromDouble(float_values[row]);
+                case Type::Bool: return PyBool_FromLong(bool_values[row]);
+                case Type::String: {
+                    std::string_view value = string(row);
+                    return PyUnicode_DecodeUTF8(value.data(), value.size(), "surrogatepass");
+                }
+                case Type::Object: {
+                    PyObject* value = object_values[row].get_obj();
+                    Py_INCREF(value);
+                    return value;
+                }
+            }
+            Py_RETURN_NONE;
+        }
+    
+    private:
+        friend class Table;
+        
+        std::string column_name;
+        Type column_type = Type::Object;
+        std::vector<uint8_t> nulls;   // 1 where the row has a value
+        std::vector<int64_t> int_values;
+        std::vector<double> float_values;
+        std::vector<uint8_t> bool_values;
+        std::vector<PyObj> object_values;
+        std::string text_values;
+        std::vector<uint64_t> text_offsets;
+        
+        void resize(size_t rows) {
+            nulls.assign(rows, 0);
+            switch (column_type) {
+                case Type::Int: int_values.assign(rows, 0); break;
+                case Type::Float: float_values.assign(rows, 0.0); break;
+                case Type::Bool: bool_values.assign(rows, 0); break;
+                case Type::String: text_offsets.assign(1, 0); text_offsets.reserve(rows + 1); break;
+                case Type::Object: object_values.assign(rows, PyObj()); break;
+            }
+        }
+        
+        // String rows are appended in order; skipped rows become empty nulls
+        void append_text(size_t row, std::string_view value) {
+            while (text_offsets.size() <= row) text_offsets.push_back(text_values.size());
+            text_values.append(value.data(), value.size());
+            text_offsets.push_back(text_values.size());
+        }
+        
+        void finish_text(size_t rows) {
+            while (text_offsets.size() <= rows) text_offsets.push_back(text_values.size());
+        }
+        
+        // Stores a Python value whose type the column was chosen for
+        bool assign(size_t row, PyObject* value) {
+            nulls[row] = 1;
+            switch (column_type) {
+                case Type::Int: int_values[row] = PyLong_AsLongLong(value); return !PyErr_Occurred();
+                case Type::Float: float_values[row] = PyFloat_AsDouble(value); return !PyErr_Occurred();
+                case Type::Bool: bool_values[row] = value == Py_True; return true;
+                case Type::String: {
+                    std::string_view text = detail::unicode_view(value);
+                    if (text.data() || PyUnicode_GET_LENGTH(value) == 0) {
+                        append_text(row, text);
+                        return true;
+                    }
+                    // Lone surrogates have no strict UTF-8 form
+                    PyObject* bytes = PyUnicode_AsEncodedString(value, "utf-8", "surrogatepass");
+                    if (!bytes) return false;
+                    append_text(row, std::string_view(PyBytes_AS_STRING(bytes), PyBytes_GET_SIZE(bytes)));
+                    Py_DECREF(bytes);
+                    return true;
+                }
+                case Type::Object: object_values[row] = PyObj(value); return true;
+            }
+            return false;
+        }
+    };
+    
+    Table() = default;
+    
+    // Builds the columns from a sequence of dicts with str keys, such as
+    // json_loads() output. Columns follow first-seen key order. A column
+    // whose values (None aside) are all bool, all int in the int64 range,
+    // all float or all str gets that type; anything mixed, including ints
+    // next to floats, stays Object so to_rows() hands back the same values.
+    // Empty on bad input.
+    static Table from_rows(const PyObj& rows) {
+        Table table;
+        PyObject* fast = rows.get_obj() ? PySequence_Fast(rows.get_obj(), "Table: expected a sequence of dicts") : nullptr;
+        if (!fast) {
+            PyErr_Clear();
+            return table;
+        }
+        
+        Py_ssize_t size = PySequence_Fast_GET_SIZE(fast);
+        PyObject** items = PySequence_Fast_ITEMS(fast);
+        
+        // Key -> column index; json_loads shares key objects, so most
+        // lookups hit on identity
+        PyObject* index = PyDict_New();
+        struct Seen { bool bools = false, ints = false, big_ints = false, floats = false, strings = false, others = false; };
+        std::vector<Seen> seen;
+        std::vector<std::string> names;
+        bool ok = index != nullptr;
+        
+        for (Py_ssize_t r = 0; ok && r < size; ++r) {
+            if (!PyDict_Check(items[r])) {
+                ok = false;
+                break;
+            }
+            
+            Py_ssize_t pos = 0;
+            PyObject *key, *value;
+            while (PyDict_Next(items[r], &pos, &key, &value)) {
+                PyObject* found = PyDict_GetItemWithError(index, key);
+                size_t column = 0;
+                if (found) {
+                    column = PyLong_AsSize_t(found);
+                } else {
+                    std::string_view name = PyUnicode_Check(key) ? detail::unicode_view(key) : std::string_view();
+                    bool named = PyUnicode_Check(key) && (name.data() || PyUnicode_GET_LENGTH(key) == 0);
+                    PyObject* position = named && !PyErr_Occurred() ? PyLong_FromSize_t(names.size()) : nullptr;
+                    if (!position || PyDict_SetItem(index, key, position) < 0) {
+                        Py_XDECREF(position);
+                        ok = false;
+                        break;
+                    }
+                    Py_DECREF(position);
+                    column = names.size();
+                    names.emplace_back(name);
+                    seen.emplace_back();
+                }
+                
+                Seen& kind = seen[column];
+                if (value == Py_None) continue;
+                if (PyBool_Check(value)) kind.bools = true;
+                else if (PyLong_CheckExact(value)) {
+                    int overflow = 0;
+                    PyLong_AsLongLongAndOverflow(value, &overflow);
+                    (overflow ? kind.big_ints : kind.ints) = true;
+                }
+                else if (PyFloat_CheckExact(value)) kind.floats = true;
+                else if (PyUnicode_CheckExact(value)) kind.strings = true;
+                else kind.others = true;
+            }
+        }
+        
+        if (ok) {
+            table.row_count = size;
+            table.column_list.reserve(names.size());
+            for (size_t c = 0; c < names.size(); ++c) {
+                const Seen& kind = seen[c];
+                Type type = Type::Object;
+                if (!kind.others && !kind.big_ints) {
+                    int families = kind.bools + kind.ints + kind.floats + kind.strings;
+                    if (families <= 1) {
+                        if (kind.bools) type = Type::Bool;
+                        else if (kind.floats) type = Type::Float;
+                        else if (kind.ints) type = Type::Int;
+                        else if (kind.strings) type = Type::String;
+                    }
+                }
+                table.column_list.emplace_back(std::move(names[c]), type, size);
+            }
+            
+            for (Py_ssize_t r = 0; ok && r < size; ++r) {
+                Py_ssize_t pos = 0;
+                PyObject *key, *value;
+                while (PyDict_Next(items[r], &pos, &key, &value)) {
+                    if (value == Py_None) continue;
+                    
+                    Column& column = table.column_list[PyLong_AsSize_t(PyDict_GetItem(index, key))];
+                    if (!column.assign(r, value)) {
+                        ok = false;
+                        break;
+                    }
+                }
+            }
+            for (Column& column : table.column_list) 
+                if (column.column_type == Type::String) column.finish_text(size);
+        }
+        
+        Py_XDECREF(index);
+        Py_DECREF(fast);
+        if (!ok) {
+            PyErr_Clear();
+            return Table();
+        }
+        return table;
+    }
+    
+    // Back to a list of dicts, every row sharing one key object per column
+    List to_rows() const {
+        PyObject* output = PyList_New(row_count);
+        std::vector<PyObj> keys;
+        for (const Column& column : column_list) 
+            keys.emplace_back(steal(PyUnicode_InternFromString(column.column_name.c_str())));
+        
+        bool ok = output != nullptr;
+        for (size_t r = 0; ok && r < row_count; ++r) {
+            PyObject* row = PyDict_New();
+            if (!row) {
+                ok = false;
+                break;
+            }
+            PyList_SET_ITEM(output, r, row);
+            
+            for (size_t c = 0; ok && c < column_list.size(); ++c) {
+                PyObject* value = column_list[c].to_python(r);
+                ok = value && keys[c].get_obj() && PyDict_SetItem(row, keys[c].get_obj(), value) == 0;
+                Py_XDECREF(value);
+            }
+        }
+        
+        if (!ok) {
+            PyErr_Clear();
+            Py_XDECREF(output);
+            return List();
+        }
+        return List(steal(output));
+    }
     
-    return 0;
-}
-
-inline List sorted(const PyObj& sequence) {
-    if (!sequence.get_obj()) return List();
+    size_t rows() const { return row_count; }
+    bool empty() const { return row_count == 0; }
+    const std::vector<Column>& columns() const { return column_list; }
     
-    PyObject* temp_list = PySequence_List(sequence.get_obj());
-    if (!temp_list) { 
-        PyErr_Clear(); 
-        return List(); 
+    // Null when there is no such column
+    const Column* column(std::string_view name) const {
+        for (const Column& column : column_list) 
+            if (column.column_name == name) return &column;
+        return nullptr;
     }
     
-    PyList_Sort(temp_list);
-    List output;
-    Py_ssize_t size = PyList_Size(temp_list);
+    // Adds or replaces a column of int64_t/other integers, double, bool or
+    // std::string values; one per row (the first column sets the row count)
+    template<typename T>
+    bool add_column(std::string name, const std::vector<T>& values) {
+        if (!column_list.empty() && values.size() != row_count) return false;
+        
+        Column column(std::move(name), column_type_of<T>(), values.size());
+        std::fill(column.nulls.begin(), column.nulls.end(), 1);
+        for (size_t r = 0; r < values.size(); ++r) {
+            if constexpr (std::is_same_v<T, bool>) column.bool_values[r] = values[r];
+            else if constexpr (std::is_floating_point_v<T>) column.float_values[r] = values[r];
+            else if constexpr (std::is_integral_v<T>) column.int_values[r] = static_cast<int64_t>(values[r]);
+            else column.append_text(r, std::string_view(values[r]));
+        }
+        if (column.column_type == Type::String) column.finish_text(values.size());
+        
+        row_count = values.size();
+        put(std::move(column));
+        return true;
+    }
     
-    for (Py_ssize_t i = 0; i < size; ++i) {
-        PyObject* item = PyList_GetItem(temp_list, i); 
-        Py_XINCREF(item);
-        PyList_Append(output.get_obj(), item); 
-        Py_XDECREF(item);
+    // Zero-copy read-only memoryview of an int ('q'), float ('d') or bool
+    // ('?') column, or of a text column's UTF-8 arena (see offsets_view()).
+    // Valid while the table lives and the column is not replaced.
+    MemoryView view(std::string_view name) const {
+        const Column* found = column(name);
+        if (!found) return MemoryView();
+        
+        switch (found->column_type) {
+            case Type::Int: return MemoryView(found->int_values.data(), found->int_values.size());
+            case Type::Float: return MemoryView(found->float_values.data(), found->float_values.size());
+            case Type::Bool: 
+                return MemoryView(reinterpret_cast<const bool*>(found->bool_values.data()), found->bool_values.size());
+            case Type::String: 
+                return MemoryView(reinterpret_cast<const uint8_t*>(found->text_values.data()), found->text_values.size());
+            case Type::Object: break;
+        }
+        return MemoryView();
     }
     
-    Py_XDECREF(temp_list);
-    return output;
-}
-
-inline PyObj reversed(const PyObj& obj) {
-    if (!obj.get_obj()) return PyObj();
+    // Row i of a text column spans [offsets[i], offsets[i + 1]) of view()
+    MemoryView offsets_view(std::string_view name) const {
+        const Column* found = column(name);
+        if (!found || found->column_type != Type::String) return MemoryView();
+        return MemoryView(found->text_offsets.data(), found->text_offsets.size());
+    }
     
-    if (obj.is_str()) {
-        PyObject* reversed_obj = PyObject_CallMethod(obj.get_obj(), "__reversed__", nullptr);
-        if (!reversed_obj) { 
-            PyErr_Clear(); 
-            return PyObj(); 
-        }
-        
-        PyObject* sequence = PySequence_List(reversed_obj); 
-        Py_XDECREF(reversed_obj);
-        PyObject* joined = PyUnicode_Join(PyUnicode_FromString(""), sequence); 
-        Py_XDECREF(sequence);
+    // Indices of the non-null rows whose T value satisfies pred
+    template<typename T, typename Pred>
+    std::vector<size_t> where(std::string_view name, Pred pred) const {
+        std::vector<size_t> selected;
+        const Column* found = column(name);
+        if (!found || !found->holds<T>()) return selected;
         
-        return PyObj(joined);
+        for (size_t r = 0; r < row_count; ++r) 
+            if (found->nulls[r] && pred(found->get<T>(r))) selected.push_back(r);
+        return selected;
     }
     
-    if (obj.is_list() || obj.is_tuple()) {
-        PyObject* reversed_obj = PyObject_CallMethod(obj.get_obj(), "__reversed__", nullptr);
-        if (!reversed_obj) { 
-            PyErr_Clear(); 
-            return PyObj(); 
-        }
+    // New table of the given rows, in that order
+    Table take(const std::vector<size_t>& selected) const {
+        Table output;
+        output.row_count = selected.size();
+        output.column_list.reserve(column_list.size());
         
-        PyObject* sequence = PySequence_List(reversed_obj); 
-        Py_XDECREF(reversed_obj);
+        for (const Column& source : column_list) {
+            Column column(source.column_name, source.column_type, selected.size());
+            for (size_t i = 0; i < selected.size(); ++i) {
+                size_t r = selected[i];
+                column.nulls[i] = source.nulls[r];
+                switch (source.column_type) {
+                    case Type::Int: column.int_values[i] = source.int_values[r]; break;
+                    case Type::Float: column.float_values[i] = source.float_values[r]; break;
+                    case Type::Bool: column.bool_values[i] = source.bool_values[r]; break;
+                    case Type::String: column.append_text(i, source.string(r)); break;
+                    case Type::Object: column.object_values[i] = source.object_values[r]; break;
+                }
+            }
+            if (column.column_type == Type::String) column.finish_text(selected.size());
+            output.column_list.push_back(std::move(column));
+        }
+        return output;
+    }
+    
+    template<typename T, typename Pred>
+    Table filter(std::string_view name, Pred pred) const {
+        return take(where<T>(name, pred));
+    }
+    
+    // Writes f(value) of every non-null T in `source` to column `target`
+    // (added or replaced); null rows stay null
+    template<typename T, typename F>
+    bool map(std::string_view source, std::string target, F f) {
+        using Result = std::decay_t<std::invoke_result_t<F&, T>>;
+        const Column* found = column(source);
+        if (!found || !found->holds<T>()) return false;
         
-        if (obj.is_tuple()) {
-            PyObject* tuple = PySequence_Tuple(sequence); 
-            Py_XDECREF(sequence); 
-            return PyObj(tuple); 
+        Column column(std::move(target), column_type_of<Result>(), row_count);
+        for (size_t r = 0; r < row_count; ++r) {
+            column.nulls[r] = found->nulls[r];
+            if (!found->nulls[r]) continue;
+            
+            Result value = f(found->get<T>(r));
+            if constexpr (std::is_same_v<Result, bool>) column.bool_values[r] = value;
+            else if constexpr (std::is_floating_point_v<Result>) column.float_values[r] = value;
+            else if constexpr (std::is_integral_v<Result>) column.int_values[r] = static_cast<int64_t>(value);
+            else column.append_text(r, std::string_view(value));
         }
+        if (column.column_type == Type::String) column.finish_text(row_count);
         
-        return PyObj(sequence);
+        put(std::move(column));
+        return true;
     }
     
-    PyErr_Clear();
-    return PyObj();
-}
-
-inline void PyObj::pretty_print(std::ostream& os, const PyObj& obj, int indent) { 
-    detail::pretty_print(os, obj, indent); 
-}
-
-inline void print(const PyObj& obj = Str("\\n")) {
-    if (obj.str() != "\\n")
-        std::cout << obj << std::endl;
-    else
-        std::cout << std::endl;
-}
-
-inline void pprint(const PyObj& obj, int indent = 0) {
-    PyObj::pretty_print(std::cout, obj, indent);
-    std::cout << std::endl;
-}
-
-// ================== Utility Functions ==================
-inline bool all(const List& list) { 
-    for (long i = 0; i < list.len(); ++i) 
-        if (!PyObject_IsTrue(list[i].get_obj())) 
-            return false; 
-    return true; 
-}
-
-inline bool any(const List& list) { 
-    for (long i = 0; i < list.len(); ++i) 
-        if (PyObject_IsTrue(list[i].get_obj())) 
-            return true; 
-    return false; 
-}
-
-inline List map(const PyObj& function, const List& list) { 
-    List output; 
-    for (long i = 0; i < list.len(); ++i) { 
-        PyObject* result = PyObject_CallFunctionObjArgs(function.get_obj(), list[i].get_obj(), nullptr); 
-        if (result) { 
-            PyList_Append(output.get_obj(), result); 
-            Py_XDECREF(result); 
-        } else {
-            PyErr_Clear();
+    // Sum of a numeric column as T (nulls count as 0); independent
+    // accumulators let the loop vectorize
+    template<typename T = double>
+    T sum(std::string_view name) const {
+        const Column* found = column(name);
+        if (!found) return T();
+        
+        auto add = [](const auto& values) {
+            T lanes[4] = {};
+            size_t size = values.size(), i = 0;
+            for (; i + 4 <= size; i += 4) 
+                for (size_t j = 0; j < 4; ++j) lanes[j] += static_cast<T>(values[i + j]);
+            for (; i < size; ++i) lanes[0] += static_cast<T>(values[i]);
+            return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+        };
+        
+        switch (found->column_type) {
+            case Type::Int: return add(found->int_values);
+            case Type::Float: return add(found->float_values);
+            case Type::Bool: return add(found->bool_values);
+            default: return T();
         }
-    } 
-    return output; 
-}
+    }
 
-inline PyObj run_code(PyObject* codeObj, const std::string& source_name) {
-    PyObject* globals = PyDict_New();
-    if (!globals) return PyObj();
+private:
+    size_t row_count = 0;
+    std::vector<Column> column_list;
     
-    PyDict_SetItemString(globals, "__builtins__", PyEval_GetBuiltins());
-
-    PyObject* result = PyEval_EvalCode(codeObj, globals, globals);
-
-    if (!result) {
-        PyErr_Print();
-        Py_DECREF(globals);
-        return PyObj();
+    template<typename T>
+    static constexpr Type column_type_of() {
+        static_assert(std::is_arithmetic_v<T> || std::is_convertible_v<const T&, std::string_view>, 
+                      "Table: columns hold integers, floating point, bool or text");
+        if constexpr (std::is_same_v<T, bool>) return Type::Bool;
+        else if constexpr (std::is_floating_point_v<T>) return Type::Float;
+        else if constexpr (std::is_integral_v<T>) return Type::Int;
+        else return Type::String;
     }
-    Py_DECREF(result);
-
-    const char* system_keys[] = {
-        "__builtins__", 
-        "__name__", 
-        "__doc__",
-        "__package__", 
-        "__loader__", 
-        "__spec__", 
-        "__annotations__"
-    };
-
-    for (const char* key : system_keys) {
-        PyObject* pyKey = PyUnicode_FromString(key);
-        if (pyKey && PyDict_Contains(globals, pyKey))
-            PyDict_DelItem(globals, pyKey);
-        Py_XDECREF(pyKey);
+    
+    void put(Column column) {
+        for (Column& existing : column_list) {
+            if (existing.column_name == column.column_name) {
+                existing = std::move(column);
+                return;
+            }
+        }
+        column_list.push_back(std::move(column));
     }
+};
 
-    return PyObj(globals);
-}
+// ================== Sub-interpreter Pool ==================
+#if PY_VERSION_HEX >= 0x030C0000
+// Runs scripts on N isolated sub-interpreters, each with its own GIL and
+// worker thread. Jobs go round-robin to per-worker queues and idle workers
+// steal from the others. Python objects cannot cross interpreters, so
+// results come back as plain C++ values. Create the pool after init_python()
+// and destroy it before exit_python(). Wait on results without holding the
+// main GIL (gil_release): imports inside a worker may briefly need it.
+class InterpreterPool {
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::function<void()>> jobs;
+        std::thread thread;
+    };
 
-inline void exec(const std::string& code) { 
-    PyRun_SimpleString(code.c_str()); 
-}
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    size_t pending = 0;
+    size_t started = 0;
+    size_t live = 0;
+    bool stopping = false;
+    std::atomic<size_t> next{0};
 
-inline PyObj eval(const std::string& code) {
-    PyObject* codeObj = Py_CompileString(code.c_str(), "<string>", Py_file_input);
-    if (!codeObj) {
-        PyErr_Print();
-        return PyObj();
+public:
+    explicit InterpreterPool(size_t size = std::thread::hardware_concurrency()) {
+        if (size == 0) size = 1;
+        
+        // Workers need the main GIL for a moment to create their interpreters
+        PyThreadState* saved = holds_gil() ? PyEval_SaveThread() : nullptr;
+        
+        for (size_t i = 0; i < size; ++i) 
+            workers.push_back(std::make_unique<Worker>());
+        for (size_t i = 0; i < size; ++i) 
+            workers[i]->thread = std::thread([this, i] { run(i); });
+        
+        {
+            std::unique_lock<std::mutex> lock(wake_mutex);
+            wake.wait(lock, [this] { return started == workers.size(); });
+        }
+        
+        if (saved) PyEval_RestoreThread(saved);
     }
-    PyObj result = run_code(codeObj, "<string>");
-    Py_DECREF(codeObj);
-    return result;
-}
-
-inline void run_file(const std::string& filename) { 
-    FILE* file = fopen(filename.c_str(), "r"); 
-    if (!file) { 
-        std::cerr << "run_file: cannot open " << filename << "\n"; 
-        return;
-    } 
-    
-    PyRun_SimpleFile(file, filename.c_str()); 
-    fclose(file); 
-}
-
-inline PyObj run_file_result(const std::string& filename) {
-    FILE* file = fopen(filename.c_str(), "r");
 
-    if (!file) {
-        PyErr_SetFromErrnoWithFilename(PyExc_OSError, filename.c_str());
-        PyErr_Print();
-        return PyObj();
+    ~InterpreterPool() {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        
+        // Workers take the main GIL again to tear their interpreters down
+        PyThreadState* saved = holds_gil() ? PyEval_SaveThread() : nullptr;
+        for (auto& worker : workers) worker->thread.join();
+        if (saved) PyEval_RestoreThread(saved);
     }
 
-    std::string code;
+    InterpreterPool(const InterpreterPool&) = delete;
+    InterpreterPool& operator=(const InterpreterPool&) = delete;
 
-    {
-        fseek(file, 0, SEEK_END);
-        long size = ftell(file);
-        rewind(file);
+    size_t size() const { return live; }
 
-        if (size <= 0) {
-            fclose(file);
-            return PyObj();
+    // Runs job on one of the interpreters with that interpreter's GIL held
+    template<typename F>
+    auto submit(F&& job) -> std::future<decltype(job())> {
+        using Result = decltype(job());
+        
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(job));
+        std::future<Result> result = task->get_future();
+        
+        if (live == 0) {
+            std::promise<Result> failed;
+            failed.set_exception(std::make_exception_ptr(
+                std::runtime_error("InterpreterPool: no interpreter could be started")));
+            return failed.get_future();
         }
-
-        code.resize(size);
-        size_t read = fread(&code[0], 1, size, file);
-        fclose(file);
-
-        if (read != static_cast<size_t>(size)) {
-            PyErr_SetString(PyExc_RuntimeError, "Failed to read entire file");
-            PyErr_Print();
-            return PyObj();
+        
+        Worker& worker = *workers[next++ % workers.size()];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            worker.jobs.emplace_back([task] { (*task)(); });
         }
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            ++pending;
+        }
+        wake.notify_one();
+        
+        return result;
     }
 
-    PyObject* codeObj = Py_CompileString(code.c_str(), filename.c_str(), Py_file_input);
-    
-    if (!codeObj) {
-        PyErr_Print();
-        return PyObj();
-    }
-
-    PyObj result = run_code(codeObj, filename);
-
-    Py_DECREF(codeObj);
-    return result;
-}
-
-// ================== JSON Functions ==================
-inline bool json_dump(const PyObj& obj, const Str& filename, int indent = -1) {
-    PyObject* json_module = PyImport_ImportModule("json");
-    if (!json_module) { 
-        PyErr_Clear(); 
-        return false; 
+    // Both hand back the script's globals as JSON text
+    std::future<std::string> eval(const std::string& code) {
+        return submit([code] { return globals_json(py::eval(code)); });
     }
 
-    PyObject* dump_func = PyObject_GetAttrString(json_module, "dump");
-    Py_XDECREF(json_module);
-    
-    if (!dump_func) { 
-        PyErr_Clear(); 
-        return false; 
+    std::future<std::string> run_file_result(const std::string& filename) {
+        return submit([filename] { return globals_json(py::run_file_result(filename)); });
     }
 
-    PyObject* file_obj = PyObject_CallMethod(
-        PyImport_ImportModule("builtins"),
-        "open", "ss", filename.str().c_str(), "w"
-    );
-    
-    if (!file_obj) { 
-        PyErr_Clear(); 
-        Py_XDECREF(dump_func); 
-        return false; 
-    }
+    // Calls module.function once per row, the rows split into one
+    // contiguous chunk per interpreter and each chunk run as one batch.
+    // The function is looked up by name in every interpreter since it
+    // cannot be shared. False when any call or conversion failed.
+    template<typename T, typename... Args>
+    bool call_batch(const std::string& module, const std::string& function,
+                    const std::vector<std::tuple<Args...>>& rows, std::vector<T>& out) {
+        out.clear();
+        if (rows.empty()) return true;
 
-    PyObject* kwargs = PyDict_New();
-    if (indent >= 0) {
-        PyDict_SetItemString(kwargs, "indent", PyLong_FromLong(indent));
-    }
+        size_t chunks = std::min(std::max<size_t>(live, 1), rows.size());
+        size_t chunk = (rows.size() + chunks - 1) / chunks;
 
-    PyObject* result = PyObject_Call(dump_func, Py_BuildValue("(OO)", obj.get_obj(), file_obj), kwargs);
-    Py_XDECREF(result);
+        std::vector<std::future<std::pair<bool, std::vector<T>>>> parts;
+        for (size_t begin = 0; begin < rows.size(); begin += chunk) {
+            const std::tuple<Args...>* first = rows.data() + begin;
+            const std::tuple<Args...>* last = rows.data() + std::min(rows.size(), begin + chunk);
+            parts.push_back(submit([&module, &function, first, last] {
+                std::pair<bool, std::vector<T>> part;
+                Function callable(import(module).attr(function));
+                part.first = callable.call_batch(first, last, part.second);
+                return part;
+            }));
+        }
 
-    PyObject* close_result = PyObject_CallMethod(file_obj, "close", nullptr);
-    Py_XDECREF(close_result);
+        bool succeeded = true;
+        std::exception_ptr failure;
+        PyThreadState* saved = holds_gil() ? PyEval_SaveThread() : nullptr;
+        for (auto& part : parts) {
+            try {
+                auto result = part.get();
+                succeeded = succeeded && result.first;
+                out.insert(out.end(), std::make_move_iterator(result.second.begin()),
+                           std::make_move_iterator(result.second.end()));
+            } catch (...) {
+                if (!failure) failure = std::current_exception();
+            }
+        }
+        if (saved) PyEval_RestoreThread(saved);
 
-    Py_XDECREF(file_obj);
-    Py_XDECREF(kwargs);
-    Py_XDECREF(dump_func);
-    
-    return true;
-}
+        if (failure) std::rethrow_exception(failure);
+        return succeeded;
+    }
 
-inline Str json_dumps(const PyObj& obj) {
-    PyObject* json_module = PyImport_ImportModule("json"); 
-    if (!json_module) { 
-        PyErr_Clear(); 
-        return Str(); 
+private:
+    // PyGILState_Check() stops checking once sub-interpreters exist
+    static bool holds_gil() {
+#if PY_VERSION_HEX >= 0x030D0000
+        return PyThreadState_GetUnchecked() != nullptr;
+#else
+        return _PyThreadState_UncheckedGet() != nullptr;
+#endif
+    }
+
+    static std::string globals_json(const PyObj& globals) {
+        if (!globals.get_obj()) 
+            throw std::runtime_error("InterpreterPool: script failed");
+        
+        Str text = json_dumps(globals);
+        if (!text.get_obj() || text.len() == 0)
+            throw std::runtime_error("InterpreterPool: globals are not JSON serializable");
+        
+        return text.str();
     }
 
-    PyObject* dumps_func = PyObject_GetAttrString(json_module, "dumps"); 
-    Py_XDECREF(json_module); 
-    if (!dumps_func) { 
-        PyErr_Clear(); 
-        return Str(); 
+    // Own queue first (oldest job), then steal the newest job of another worker
+    bool take(size_t index, std::function<void()>& job) {
+        for (size_t n = 0; n < workers.size(); ++n) {
+            Worker& worker = *workers[(index + n) % workers.size()];
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            
+            if (worker.jobs.empty()) continue;
+            
+            if (n == 0) {
+                job = std::move(worker.jobs.front());
+                worker.jobs.pop_front();
+            } else {
+                job = std::move(worker.jobs.back());
+                worker.jobs.pop_back();
+            }
+            return true;
+        }
+        return false;
     }
 
-    PyObject* result = PyObject_CallFunctionObjArgs(dumps_func, obj.get_obj(), nullptr); 
-    Py_XDECREF(dumps_func);
-    
-    Str output(result); 
-    Py_XDECREF(result); 
-    return output;
-}
+    void run(size_t index) {
+        PyGILState_STATE main_gil = PyGILState_Ensure();
+        PyThreadState* main_state = PyThreadState_Get();
 
-inline PyObj json_load(const Str& filename) {
-    PyObject* json_module = PyImport_ImportModule("json");
-    if (!json_module) { 
-        PyErr_Clear(); 
-        return PyObj(); 
-    }
+        PyInterpreterConfig config{};
+        config.use_main_obmalloc = 0;
+        config.allow_fork = 0;
+        config.allow_exec = 0;
+        config.allow_threads = 1;
+        config.allow_daemon_threads = 0;
+        config.check_multi_interp_extensions = 1;
+        config.gil = PyInterpreterConfig_OWN_GIL;
 
-    PyObject* load_func = PyObject_GetAttrString(json_module, "load");
-    Py_XDECREF(json_module);
-    if (!load_func) { 
-        PyErr_Clear(); 
-        return PyObj(); 
+        // Switches this thread over to the new interpreter and its GIL
+        PyThreadState* state = nullptr;
+        PyStatus status = Py_NewInterpreterFromConfig(&state, &config);
+        
+        bool created = !PyStatus_Exception(status) && state;
+        if (!created) {
+            std::cerr << "InterpreterPool: cannot create interpreter: " 
+                      << (status.err_msg ? status.err_msg : "unknown error") << "\n";
+            PyGILState_Release(main_gil);
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            ++started;
+            if (created) ++live;
+        }
+        wake.notify_all();
+        
+        if (!created) return;
+        
+        detail::owns_interpreter_gil() = true;
+        PyThreadState* idle = PyEval_SaveThread();
+        
+        // A py::error must not leave its interpreter, so jobs keep printing
+        ErrorPolicyScope print_errors(ErrorPolicy::Print);
+        
+        std::function<void()> job;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(wake_mutex);
+                wake.wait(lock, [this] { return pending > 0 || stopping; });
+                if (pending == 0) break;
+                --pending;
+            }
+            
+            // A reserved job is always in one of the queues
+            while (!take(index, job)) std::this_thread::yield();
+            
+            PyEval_RestoreThread(idle);
+            job();
+            job = nullptr;
+            idle = PyEval_SaveThread();
+        }
+        
+        PyEval_RestoreThread(idle);
+        detail::owns_interpreter_gil() = false;
+        detail::run_interpreter_exit_hooks();
+        Py_EndInterpreter(state);
+        
+        PyEval_RestoreThread(main_state);
+        PyGILState_Release(main_gil);
     }
+};
+#endif
 
-    PyObject* file_obj = PyObject_CallMethod(
-        PyImport_ImportModule("builtins"),
-        "open", "ss", filename.str().c_str(), "r"
-    );
+// ================== Leak Check Mode ==================
+#ifdef PYOBJ_LEAK_CHECK
+// Build with -DPYOBJ_LEAK_CHECK to count live interpreter objects
+// (sys.getallocatedblocks) around API calls. leak_check() repeats a call and
+// returns how many objects it left behind, LeakCheck reports it for a scope.
+namespace detail {
+inline Py_ssize_t allocated_blocks() {
+    PyGC_Collect();
+    
+    PyObject* func = PySys_GetObject("getallocatedblocks");
+    if (!func) return 0;
     
-    if (!file_obj) { 
+    PyObject* result = PyObject_CallObject(func, nullptr);
+    if (!result) { 
         PyErr_Clear(); 
-        Py_XDECREF(load_func); 
-        return PyObj(); 
+        return 0; 
     }
+    
+    Py_ssize_t blocks = PyLong_AsSsize_t(result);
+    Py_DECREF(result);
+    
+    return blocks;
+}
+} // end namespace detail
 
-    PyObject* result = PyObject_CallFunctionObjArgs(load_func, file_obj, nullptr);
-    PyObject* close_result = PyObject_CallMethod(file_obj, "close", nullptr);
-    Py_XDECREF(close_result);
-    Py_XDECREF(file_obj);
-    Py_XDECREF(load_func);
+class LeakCheck {
+    std::string name;
+    Py_ssize_t before;
 
-    return result ? PyObj(result) : PyObj();
-}
+public:
+    explicit LeakCheck(const std::string& n) : name(n), before(detail::allocated_blocks()) {}
 
-inline PyObj json_loads(const Str& json_string) {
-    PyObject* json_module = PyImport_ImportModule("json"); 
-    if (!json_module) { 
-        PyErr_Clear(); 
-        return PyObj(); 
-    }
+    Py_ssize_t leaked() const { return detail::allocated_blocks() - before; }
 
-    PyObject* loads_func = PyObject_GetAttrString(json_module, "loads"); 
-    Py_XDECREF(json_module); 
-    if (!loads_func) { 
-        PyErr_Clear(); 
-        return PyObj(); 
+    ~LeakCheck() {
+        Py_ssize_t delta = leaked();
+        if (delta > 0)
+            std::cerr << "leak-check: " << name << " left " << delta << " live objects\n";
     }
+};
+
+template<typename F>
+Py_ssize_t leak_check(const std::string& name, F&& call, int iterations = 100) {
+    // Warm up interned names, caches and free lists first
+    for (int i = 0; i < iterations; ++i) call();
     
-    PyObject* result = PyObject_CallFunctionObjArgs(loads_func, json_string.get_obj(), nullptr); 
-    Py_XDECREF(loads_func);
+    Py_ssize_t before = detail::allocated_blocks();
+    for (int i = 0; i < iterations; ++i) call();
+    Py_ssize_t delta = detail::allocated_blocks() - before;
     
-    return result ? PyObj(result) : PyObj();
+    // Free lists and type caches drift by a few blocks, a real leak grows
+    // by at least one object per call
+    if (delta >= iterations)
+        std::cerr << "leak-check: " << name << " left " << delta 
+                  << " live objects after " << iterations << " calls\n";
+    return delta;
 }
+#endif
 
 
 } // end namespace py
+
+// Dict::Item unpacks with structured bindings
+namespace std {
+template<>
+struct tuple_size<py::Dict::Item> : integral_constant<size_t, 2> {};
+
+template<size_t I>
+struct tuple_element<I, py::Dict::Item> { using type = const py::PyObj; };
+}
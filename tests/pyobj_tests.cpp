@@ -0,0 +1,235 @@
+// Regression and leak tests for the pyobj wrappers, run by ctest. Built with
+// PYOBJ_LEAK_CHECK: every entry point is repeated under leak_check(), which
+// fails the test when a call leaves an object behind. Each other case pins
+// down a bug that was fixed once.
+#include "pyobj.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace py;
+
+namespace {
+
+int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            ++failures; \
+        } \
+    } while (0)
+
+constexpr int iterations = 100;
+
+// leak_check() reports a leak once the live object count grows by one per call
+template<typename F>
+void check_no_leak(const char* name, F&& call) {
+    Py_ssize_t delta = leak_check(name, std::forward<F>(call), iterations);
+    if (delta >= iterations) {
+        std::fprintf(stderr, "%s leaked %zd objects in %d calls\n", name, delta, iterations);
+        ++failures;
+    }
+}
+
+// Reads a __main__ global without going through Module::attr's cache
+long main_long(const char* name) {
+    PyObject* value = PyObject_GetAttrString(PyImport_AddModule("__main__"), name);
+    long result = value ? PyLong_AsLong(value) : -1;
+    Py_XDECREF(value);
+    return result;
+}
+
+bool equal(const PyObj& a, const PyObj& b) {
+    int same = PyObject_RichCompareBool(a.get_obj(), b.get_obj(), Py_EQ);
+    if (same < 0) PyErr_Clear();
+    return same == 1;
+}
+
+// ================== Leak checks ==================
+void test_leaks_eval() {
+    check_no_leak("eval", [] { eval("x = 3 * 7 + 1"); });
+    check_no_leak("eval_expr", [] { eval_expr("3 * 7 + 1"); });
+    check_no_leak("exec", [] { exec("leak_probe = [1, 2, 3]"); });
+}
+
+void test_leaks_calls() {
+    Function add(eval_expr("lambda a, b: a + b"));
+    std::vector<std::tuple<int, int>> rows = { {1, 2}, {3, 4}, {5, 6} };
+    List python_rows(steal(PyList_New(0)));
+    for (int i = 0; i < 3; ++i) PyList_Append(python_rows.get_obj(), Tuple{ i, i }.get_obj());
+
+    check_no_leak("Function::call", [&] { add(1, 2); });
+    check_no_leak("Function::call_batch", [&] { add.call_batch(rows); });
+    check_no_leak("Function::call_batch(List)", [&] { add.call_batch(python_rows); });
+}
+
+void test_leaks_containers() {
+    check_no_leak("List", [] { List{ 1, 2, 3 }.append(4); });
+    check_no_leak("Tuple", [] { Tuple{ 1, "two", 3.0 }; });
+    check_no_leak("Set", [] { Set{ 1, 2, 3 } |= Set{ 3, 4 }; });
+    check_no_leak("Dict", [] {
+        Dict d = { {"a", 1}, {"b", 2} };
+        d["c"] = 3;
+        for (auto [key, value] : d) (void)key;
+    });
+    check_no_leak("Str::split/join", [] { Str(",").join(Str("a,b,c").split(",")); });
+}
+
+void test_leaks_conversions() {
+    List numbers = from_vector(std::vector<long>{ 5, 3, 1, 4 });
+
+    check_no_leak("to_vector/from_vector", [&] { from_vector(to_vector<long>(numbers)); });
+    check_no_leak("sorted", [&] { sorted(numbers); });
+    check_no_leak("map<T>", [&] { map([](long x) { return x + 1; }, numbers, 1); });
+    check_no_leak("pipe", [&] { (pipe(numbers) | map([](const PyObj& x) { return x; }) | take(2)).to_list(); });
+    check_no_leak("json", [] { json_loads(json_dumps(eval_expr("{'a': [1, 2.5, None, 'x']}"))); });
+    check_no_leak("Table", [] {
+        Table::from_rows(eval_expr("[{'a': 1, 'b': 'x'}, {'a': 2, 'b': None}]")).to_rows();
+    });
+}
+
+void test_leaks_errors() {
+    check_no_leak("ErrorPolicy::Ignore", [] {
+        ErrorPolicyScope scope(ErrorPolicy::Ignore);
+        eval_expr("1 / 0");
+    });
+    check_no_leak("ErrorPolicy::Throw", [] {
+        ErrorPolicyScope scope(ErrorPolicy::Throw);
+        try {
+            eval_expr("1 / 0");
+        } catch (const error&) {
+        }
+    });
+    check_no_leak("ErrorBatch", [] {
+        ErrorBatch batch;
+        eval_expr("{}['missing']");
+        batch.take();
+    });
+    check_no_leak("attempt", [] { attempt([] { return eval_expr("undefined_name"); }); });
+}
+
+// ================== Regressions ==================
+// A Dict::Item used to point into the iterator it came from
+void test_dict_item_outlives_iterator() {
+    Dict d = { {"a", 1}, {"b", 2} };
+
+    auto it = d.begin();
+    Dict::Item first = *it;
+    ++it;
+    CHECK(Str(first.key()) == "a");
+    CHECK(PyLong_AsLong(first.value().get_obj()) == 1);
+
+    std::vector<Dict::Item> items(d.begin(), d.end());
+    CHECK(items.size() == 2);
+    CHECK(Str(items[1].key()) == "b");
+    CHECK(PyLong_AsLong(items[1].value().get_obj()) == 2);
+}
+
+// take(0) used to pull (and map) the first item before stopping
+void test_take_zero_pulls_nothing() {
+    exec("calls = 0\n"
+         "def counted(x):\n"
+         "    global calls\n"
+         "    calls += 1\n"
+         "    return x\n"
+         "pulled = 0\n"
+         "def source():\n"
+         "    global pulled\n"
+         "    for i in range(10):\n"
+         "        pulled += 1\n"
+         "        yield i\n");
+    Module main = import("__main__");
+    PyObj counted = main.attr("counted");
+
+    CHECK(len((pipe(eval_expr("[1, 2, 3]")) | map(counted) | take(0)).to_list()) == 0);
+    CHECK(main_long("calls") == 0);
+
+    CHECK((pipe(Function(main.attr("source"))()) | map(counted) | take(0)).to_vector<long>().empty());
+    CHECK(main_long("pulled") == 0);
+    CHECK(main_long("calls") == 0);
+}
+
+// A column mixing ints and floats used to be coerced to one of them
+void test_mixed_number_column_round_trips() {
+    PyObj rows = eval_expr("[{'n': 1}, {'n': 2.5}, {'n': 9007199254740993}]");
+    Table table = Table::from_rows(rows);
+
+    CHECK(table.column("n") != nullptr);
+    CHECK(table.column("n") && table.column("n")->type() == Table::Type::Object);
+    CHECK(equal(table.to_rows(), rows));
+}
+
+// Two module objects named alike used to share Module::attr's cache
+void test_module_attr_keyed_by_module() {
+    Module first(steal(PyModule_New("pyobj_tests_twin")));
+    Module second(steal(PyModule_New("pyobj_tests_twin")));
+    PyModule_AddIntConstant(first.get_obj(), "value", 1);
+    PyModule_AddIntConstant(second.get_obj(), "value", 2);
+
+    CHECK(PyLong_AsLong(first.attr("value").get_obj()) == 1);
+    CHECK(PyLong_AsLong(second.attr("value").get_obj()) == 2);
+}
+
+// An NDJSON file whose rows are arrays used to stream as one array
+void test_json_stream_array_rows() {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "pyobj_tests_rows.ndjson";
+    std::ofstream(path) << "[1, 2]\n[3, 4]\n";
+
+    std::vector<PyObj> values;
+    JsonStream stream = json_stream(path.string());
+    for (const PyObj& value : stream) values.push_back(value);
+    std::filesystem::remove(path);
+
+    CHECK(!stream.failed());
+    CHECK(values.size() == 2);
+    CHECK(values.size() == 2 && equal(values[1], eval_expr("[3, 4]")));
+}
+
+// run_file used to print its own errors, bypassing the error policy
+void test_run_file_reports_errors() {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "pyobj_tests_fail.py";
+    std::ofstream(path) << "raise KeyError('boom')\n";
+
+    ErrorBatch batch;
+    run_file(path.string());
+    std::filesystem::remove(path);
+
+    CHECK(batch.size() == 1);
+    CHECK(!PyErr_Occurred());
+}
+
+} // namespace
+
+int main() {
+    init_python();
+
+    const std::pair<const char*, void (*)()> tests[] = {
+        { "leaks: eval", test_leaks_eval },
+        { "leaks: calls", test_leaks_calls },
+        { "leaks: containers", test_leaks_containers },
+        { "leaks: conversions", test_leaks_conversions },
+        { "leaks: errors", test_leaks_errors },
+        { "Dict::Item outlives its iterator", test_dict_item_outlives_iterator },
+        { "take(0) pulls nothing", test_take_zero_pulls_nothing },
+        { "mixed int/float column round trips", test_mixed_number_column_round_trips },
+        { "Module::attr keyed by module", test_module_attr_keyed_by_module },
+        { "json_stream array rows", test_json_stream_array_rows },
+        { "run_file reports errors", test_run_file_reports_errors },
+    };
+
+    for (const auto& test : tests) {
+        int before = failures;
+        test.second();
+        std::printf("%s %s\n", failures == before ? "[ ok ]" : "[FAIL]", test.first);
+    }
+
+    exit_python();
+    return failures == 0 ? 0 : 1;
+}